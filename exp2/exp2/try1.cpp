@@ -2,6 +2,16 @@
 #include <cctype>
 #include <cmath>
 #include <vector>
+#include <string_view>
+#include <charconv>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <functional>
 
 using namespace std;
 
@@ -80,24 +90,229 @@ void Stack<T>::DisplayStack()
 		cout << "\t|\t" << values[i] << "\t|" << endl;
 	cout << "\t|---------------|" << endl;
 }
+
+// Lock-free LIFO over a fixed pool of `size` nodes (Treiber stack). The head
+// word packs a 32-bit node index with a 32-bit version tag that changes on
+// every update, so a stale compare-and-swap never succeeds after ABA. Nodes
+// are recycled through a second Treiber stack and never freed while in use.
+// When the head CAS fails, Push and Pop meet in an elimination array instead
+// of retrying on the contended head.
+template <typename T>
+class ConcurrentStack
+{
+public:
+	ConcurrentStack(int size);
+	~ConcurrentStack();
+	bool IsEmpty() const { return Index(head.load()) == NIL; }
+	bool Push(const T& x);
+	bool Pop(T& x);
+private:
+	static const uint32_t NIL = 0xFFFFFFFFu;
+	static const int ELIM_SLOTS = 16;
+	static const int ELIM_SPIN = 64;
+	static const uint64_t FULL = uint64_t(1) << 63;
+	enum PopResult { POPPED, EMPTY, CONTENDED };
+
+	struct Node
+	{
+		T value;
+		atomic<uint32_t> next;
+	};
+
+	static uint32_t Index(uint64_t w) { return static_cast<uint32_t>(w); }
+	static uint64_t Tagged(uint32_t idx, uint64_t old) { return (((old >> 32) + 1) << 32) | idx; }
+	static uint64_t NextSeq(uint64_t w) { return (((w >> 32) + 1) & 0x7FFFFFFF) << 32; }
+	static int RandomSlot();
+
+	bool TryPush(atomic<uint64_t>& top, uint32_t idx);
+	PopResult TryPop(atomic<uint64_t>& top, uint32_t& idx);
+	bool EliminatePush(uint32_t idx);
+	bool EliminatePop(uint32_t& idx);
+
+	Node* nodes;
+	atomic<uint64_t> head;
+	atomic<uint64_t> freeList;
+	atomic<uint64_t> slots[ELIM_SLOTS];
+};
+
+template <typename T>
+ConcurrentStack<T>::ConcurrentStack(int size)
+{
+	nodes = new Node[size];
+	for (int i = 0; i < size; i++)
+		nodes[i].next.store(i + 1 < size ? i + 1 : NIL);
+	head.store(NIL);
+	freeList.store(size > 0 ? 0 : NIL);
+	for (int i = 0; i < ELIM_SLOTS; i++)
+		slots[i].store(0);
+}
+
+template <typename T>
+ConcurrentStack<T>::~ConcurrentStack()
+{
+	delete[] nodes;
+}
+
+template <typename T>
+int ConcurrentStack<T>::RandomSlot()
+{
+	static thread_local uint32_t state = static_cast<uint32_t>(hash<thread::id>()(this_thread::get_id())) | 1;
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state % ELIM_SLOTS;
+}
+
+template <typename T>
+bool ConcurrentStack<T>::TryPush(atomic<uint64_t>& top, uint32_t idx)
+{
+	uint64_t old = top.load(memory_order_acquire);
+	nodes[idx].next.store(Index(old), memory_order_relaxed);
+	return top.compare_exchange_weak(old, Tagged(idx, old), memory_order_release, memory_order_relaxed);
+}
+
+template <typename T>
+typename ConcurrentStack<T>::PopResult ConcurrentStack<T>::TryPop(atomic<uint64_t>& top, uint32_t& idx)
+{
+	uint64_t old = top.load(memory_order_acquire);
+	if (Index(old) == NIL)
+		return EMPTY;
+	uint32_t next = nodes[Index(old)].next.load(memory_order_relaxed);
+	if (!top.compare_exchange_weak(old, Tagged(next, old), memory_order_acquire, memory_order_relaxed))
+		return CONTENDED;
+	idx = Index(old);
+	return POPPED;
+}
+
+template <typename T>
+bool ConcurrentStack<T>::EliminatePush(uint32_t idx)
+{
+	atomic<uint64_t>& slot = slots[RandomSlot()];
+	uint64_t v = slot.load(memory_order_relaxed);
+	if (v & FULL)
+		return false;
+	uint64_t offer = FULL | NextSeq(v) | idx;
+	if (!slot.compare_exchange_strong(v, offer, memory_order_release, memory_order_relaxed))
+		return false;
+	for (int i = 0; i < ELIM_SPIN; i++)
+		if (slot.load(memory_order_relaxed) != offer)
+			return true;
+	// Withdraw the offer; failure means a popper took the node meanwhile.
+	return !slot.compare_exchange_strong(offer, NextSeq(offer), memory_order_relaxed);
+}
+
+template <typename T>
+bool ConcurrentStack<T>::EliminatePop(uint32_t& idx)
+{
+	atomic<uint64_t>& slot = slots[RandomSlot()];
+	uint64_t v = slot.load(memory_order_relaxed);
+	if (!(v & FULL) || !slot.compare_exchange_strong(v, NextSeq(v), memory_order_acquire, memory_order_relaxed))
+		return false;
+	idx = Index(v);
+	return true;
+}
+
+template <typename T>
+bool ConcurrentStack<T>::Push(const T& x)
+{
+	uint32_t idx;
+	PopResult r;
+	while ((r = TryPop(freeList, idx)) == CONTENDED);
+	if (r == EMPTY)
+		return false;
+	nodes[idx].value = x;
+	while (!TryPush(head, idx))
+		if (EliminatePush(idx))
+			return true;
+	return true;
+}
+
+template <typename T>
+bool ConcurrentStack<T>::Pop(T& x)
+{
+	uint32_t idx;
+	for (;;)
+	{
+		PopResult r = TryPop(head, idx);
+		if (r == EMPTY)
+			return false;
+		if (r == POPPED || EliminatePop(idx))
+			break;
+	}
+	x = nodes[idx].value;
+	while (!TryPush(freeList, idx));
+	return true;
+}
+
+// Mutex-guarded Stack<T> with the ConcurrentStack interface, used as the
+// baseline in benchConcurrentStack.
+template <typename T>
+class LockedStack
+{
+public:
+	LockedStack(int size) : s(size) {}
+	bool Push(const T& x)
+	{
+		lock_guard<mutex> lock(m);
+		if (s.IsFull())
+			return false;
+		s.Push(x);
+		return true;
+	}
+	bool Pop(T& x)
+	{
+		lock_guard<mutex> lock(m);
+		if (s.IsEmpty())
+			return false;
+		x = s.Pop();
+		return true;
+	}
+private:
+	Stack<T> s;
+	mutex m;
+};
+
+// Milliseconds for `threads` workers each doing `pairs` push/pop pairs.
+template <typename S>
+long long benchConcurrentStack(int threads, int pairs)
+{
+	S s(threads * 2);
+	vector<thread> pool;
+	auto t0 = chrono::steady_clock::now();
+	for (int t = 0; t < threads; t++)
+		pool.emplace_back([&s, pairs, t]()
+			{
+				int v;
+				for (int i = 0; i < pairs; i++)
+				{
+					s.Push(t);
+					s.Pop(v);
+				}
+			});
+	for (thread& t : pool)
+		t.join();
+	return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - t0).count();
+}
 /// 
 
 
 
 
-const int N_OPTR = 9;
+const int N_OPTR = 10;
 
+// '~' is the internal code for unary minus, produced by the lexer
 const char pri[N_OPTR][N_OPTR] =
 {
-	{'>', '>', '<', '<', '<', '<', '<', '>', '>'},
-	{'>', '>', '<', '<', '<', '<', '<', '>', '>'},
-	{'>', '>', '>', '>', '<', '<', '<', '>', '>'},
-	{'>', '>', '>', '>', '<', '<', '<', '>', '>'},
-	{'>', '>', '>', '>', '>', '<', '<', '>', '>'},
-	{'>', '>', '>', '>', '>', '>', ' ', '>', '>'},
-	{'<', '<', '<', '<', '<', '<', '<', '=', ' '},
-	{' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
-	{'<', '<', '<', '<', '<', '<', '<', ' ', '='}
+	{'>', '>', '<', '<', '<', '<', '<', '>', '>', '<'},
+	{'>', '>', '<', '<', '<', '<', '<', '>', '>', '<'},
+	{'>', '>', '>', '>', '<', '<', '<', '>', '>', '<'},
+	{'>', '>', '>', '>', '<', '<', '<', '>', '>', '<'},
+	{'>', '>', '>', '>', '>', '<', '<', '>', '>', '<'},
+	{'>', '>', '>', '>', '>', '>', ' ', '>', '>', ' '},
+	{'<', '<', '<', '<', '<', '<', '<', '=', ' ', '<'},
+	{' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
+	{'<', '<', '<', '<', '<', '<', '<', ' ', '=', '<'},
+	{'>', '>', '>', '>', '<', '<', '<', '>', '>', '<'}
 };
 
 int optrIndex(char op) {
@@ -111,6 +326,7 @@ int optrIndex(char op) {
 	case '(': return 6;
 	case ')': return 7;
 	case '\0': return 8;
+	case '~': return 9;
 	default: return -1;
 	}
 }
@@ -177,6 +393,8 @@ double calcu(char op, double operand)
 			exit(-1);
 		}
 		return factorial(static_cast<int>(operand));
+	case '~':
+		return -operand;
 	default:
 		cout << "Error" << endl;
 		exit(-1);
@@ -184,36 +402,104 @@ double calcu(char op, double operand)
 }
 
 
-double evaluate(const char* s)
+struct Token
+{
+	enum Kind { NUMBER, OPERATOR, END, INVALID } kind;
+	string_view text;
+	double value;
+	char op;
+};
+
+// Splits an expression into tokens that point back into the source buffer.
+// A '-' seen where an operand is expected is reported as the unary operator '~'.
+// Where an operand is expected only a number, '(' or '~' is accepted, so "1+*2",
+// "1+", "()" and "" are INVALID; where an operator is expected a number or '('
+// ("2 3", "1.5.3") is INVALID.
+class Lexer
 {
-	Stack<double> opnd(100);
-	Stack<char> optr(100);
+public:
+	Lexer(string_view src) : src(src), pos(0), expectOperand(true) {}
+	Token Next();
+private:
+	string_view src;
+	size_t pos;
+	bool expectOperand;
+};
+
+Token Lexer::Next()
+{
+	while (pos < src.size() && isspace(static_cast<unsigned char>(src[pos])))
+		pos++;
+	Token t;
+	t.value = 0;
+	t.op = '\0';
+	if (pos >= src.size())
+	{
+		t.kind = expectOperand ? Token::INVALID : Token::END;
+		t.text = src.substr(pos);
+		return t;
+	}
+	const char* first = src.data() + pos;
+	const char* last = src.data() + src.size();
+	if (isdigit(static_cast<unsigned char>(*first)) || *first == '.')
+	{
+		from_chars_result r = from_chars(first, last, t.value);
+		if (r.ec != errc())
+		{
+			t.kind = Token::INVALID;
+			t.text = src.substr(pos, 1);
+			return t;
+		}
+		t.kind = expectOperand ? Token::NUMBER : Token::INVALID;
+		t.text = src.substr(pos, r.ptr - first);
+		pos += t.text.size();
+		expectOperand = false;
+		return t;
+	}
+	t.op = *first;
+	if (t.op == '-' && expectOperand)
+		t.op = '~';
+	bool valid = expectOperand ? t.op == '(' || t.op == '~'
+		: optrIndex(t.op) != -1 && t.op != '\0' && t.op != '(' && t.op != '~';
+	t.kind = valid ? Token::OPERATOR : Token::INVALID;
+	t.text = src.substr(pos, 1);
+	pos++;
+	expectOperand = t.op != ')' && t.op != '!';
+	return t;
+}
+
+double evaluate(string_view expr)
+{
+	Stack<double> opnd(static_cast<int>(expr.size()) + 1);
+	Stack<char> optr(static_cast<int>(expr.size()) + 2);
+	Lexer lexer(expr);
+	Token t = lexer.Next();
 	optr.Push('\0');
 	while (!optr.IsEmpty())
 	{
-		if (isdigit(*s))
+		if (t.kind == Token::INVALID)
 		{
-			double num = 0;
-			while (isdigit(*s))
-			{
-				num = num * 10 + (*s - '0');
-				s++;
-			}
-			opnd.Push(num);
+			cout << "Error" << endl;
+			exit(-1);
+		}
+		if (t.kind == Token::NUMBER)
+		{
+			opnd.Push(t.value);
+			t = lexer.Next();
 		}
 		else
 		{
-			switch (getPriority(optr.Top(), *s))
+			switch (getPriority(optr.Top(), t.op))
 			{
 			case '<':
-				optr.Push(*s);
-				s++;
+				optr.Push(t.op);
+				t = lexer.Next();
 				break;
 
 			case '>':
 			{
 				char op = optr.Pop();
-				if ('!' == op)
+				if ('!' == op || '~' == op)
 				{
 					opnd.Push(calcu(op, opnd.Pop()));
 				}
@@ -228,14 +514,24 @@ double evaluate(const char* s)
 
 			case '=':
 				optr.Pop();
-				s++;
+				if (t.kind != Token::END)
+					t = lexer.Next();
 				break;
+
+			default:
+				cout << "Error" << endl;
+				exit(-1);
 			}
 		}
 	}
 	return opnd.Pop();
 }
 
+double evaluate(const char* s)
+{
+	return evaluate(string_view(s));
+}
+
 int largestRectangleArea(const vector<int>& heights)
 {
 	Stack<int> s(100);
@@ -265,6 +561,314 @@ int largestRectangleArea(const vector<int>& heights)
 	return maxArea;
 }
 
+struct Rectangle
+{
+	long long area;
+	long long left;   // first bar of the rectangle
+	long long right;  // one past the last bar
+	int height;
+};
+
+// Largest rectangle over a histogram fed in chunks; only the monotonic
+// stack of (start, height) pairs is kept, so memory is O(stack depth).
+class HistogramStream
+{
+public:
+	HistogramStream() : n(0) { best = { 0, 0, 0, 0 }; }
+
+	template <typename It>
+	void Feed(It first, It last)
+	{
+		for (; first != last; ++first, ++n)
+		{
+			int h = *first;
+			long long start = n;
+			while (!bars.empty() && bars.back().second >= h)
+			{
+				start = bars.back().first;
+				Close(n);
+			}
+			bars.push_back({ start, h });
+		}
+	}
+
+	Rectangle Finish()
+	{
+		while (!bars.empty())
+			Close(n);
+		return best;
+	}
+
+	long long Count() const { return n; }
+
+	// Starts a new histogram; the stack keeps its capacity.
+	void Reset()
+	{
+		n = 0;
+		bars.clear();
+		best = { 0, 0, 0, 0 };
+	}
+
+private:
+	void Close(long long right)
+	{
+		long long start = bars.back().first;
+		int h = bars.back().second;
+		bars.pop_back();
+		long long area = static_cast<long long>(h) * (right - start);
+		if (area > best.area)
+			best = { area, start, right, h };
+	}
+
+	long long n;
+	vector<pair<long long, int>> bars;
+	Rectangle best;
+};
+
+Rectangle largestRectangleArea(istream& in, size_t chunk = 4096)
+{
+	HistogramStream hs;
+	chunk = max<size_t>(chunk, 1);
+	vector<int> buf(chunk);
+	size_t count;
+	do
+	{
+		for (count = 0; count < chunk && in >> buf[count]; count++);
+		hs.Feed(buf.begin(), buf.begin() + count);
+	} while (count == chunk);
+	return hs.Finish();
+}
+
+// Segment summary for the parallel pass: the strict prefix and suffix minima
+// are the only bars a neighbouring segment can use as its nearest smaller bar.
+struct HistogramSegment
+{
+	size_t begin, end;
+	int minHeight;
+	vector<size_t> prefixMin;  // increasing index, decreasing height
+	vector<size_t> suffixMin;  // decreasing index, decreasing height
+	long long best;
+};
+
+static size_t firstBelow(const vector<int>& heights, const vector<size_t>& mins, int h)
+{
+	return *partition_point(mins.begin(), mins.end(),
+		[&](size_t j) { return heights[j] >= h; });
+}
+
+static void summarizeSegment(const vector<int>& heights, HistogramSegment& seg)
+{
+	seg.minHeight = heights[seg.begin];
+	for (size_t i = seg.begin; i < seg.end; i++)
+	{
+		if (seg.prefixMin.empty() || heights[i] < heights[seg.prefixMin.back()])
+			seg.prefixMin.push_back(i);
+		seg.minHeight = min(seg.minHeight, heights[i]);
+	}
+	for (size_t i = seg.end; i-- > seg.begin; )
+		if (seg.suffixMin.empty() || heights[i] < heights[seg.suffixMin.back()])
+			seg.suffixMin.push_back(i);
+}
+
+// Every bar is scored with its strict nearest smaller bars on both sides.
+// Boundaries outside the segment are found through the neighbours' minima;
+// bars that need them arrive in decreasing height, so the segment cursors
+// only move outward.
+static void scanSegment(const vector<int>& heights, vector<HistogramSegment>& segs, size_t s)
+{
+	HistogramSegment& seg = segs[s];
+	vector<pair<size_t, long long>> st;  // (bar, left boundary)
+	long long best = 0;
+	size_t k = s;
+	for (size_t i = seg.begin; i < seg.end; i++)
+	{
+		while (!st.empty() && heights[st.back().first] >= heights[i])
+		{
+			long long h = heights[st.back().first];
+			best = max(best, h * (static_cast<long long>(i) - st.back().second - 1));
+			st.pop_back();
+		}
+		long long left;
+		if (!st.empty())
+			left = st.back().first;
+		else
+		{
+			while (k > 0 && segs[k - 1].minHeight >= heights[i])
+				k--;
+			left = k == 0 ? -1 : firstBelow(heights, segs[k - 1].suffixMin, heights[i]);
+		}
+		st.push_back({ i, left });
+	}
+	k = s + 1;
+	while (!st.empty())
+	{
+		int h = heights[st.back().first];
+		while (k < segs.size() && segs[k].minHeight >= h)
+			k++;
+		long long right = k == segs.size() ? heights.size() : firstBelow(heights, segs[k].prefixMin, h);
+		best = max(best, static_cast<long long>(h) * (right - st.back().second - 1));
+		st.pop_back();
+	}
+	seg.best = best;
+}
+
+long long largestRectangleAreaParallel(const vector<int>& heights, unsigned threads = 0)
+{
+	if (threads == 0)
+		threads = max(1u, thread::hardware_concurrency());
+	size_t n = heights.size();
+	size_t parts = min<size_t>(threads, n);
+	if (parts == 0)
+		return 0;
+
+	vector<HistogramSegment> segs(parts);
+	for (size_t s = 0; s < parts; s++)
+	{
+		segs[s].begin = n * s / parts;
+		segs[s].end = n * (s + 1) / parts;
+	}
+
+	vector<thread> pool;
+	for (size_t s = 0; s < parts; s++)
+		pool.emplace_back(summarizeSegment, cref(heights), ref(segs[s]));
+	for (thread& t : pool)
+		t.join();
+	pool.clear();
+	for (size_t s = 0; s < parts; s++)
+		pool.emplace_back(scanSegment, cref(heights), ref(segs), s);
+	for (thread& t : pool)
+		t.join();
+
+	long long best = 0;
+	for (const HistogramSegment& seg : segs)
+		best = max(best, seg.best);
+	return best;
+}
+
+// Occupancy grid with one bit per cell, each row padded to whole 64-bit words.
+class BitGrid
+{
+public:
+	BitGrid(int rows, int cols)
+		: rows(rows), cols(cols), words((cols + 63) / 64), bits(static_cast<size_t>(rows) * words) {}
+	int Rows() const { return rows; }
+	int Cols() const { return cols; }
+	const uint64_t* Row(int r) const { return &bits[static_cast<size_t>(r) * words]; }
+	bool Get(int r, int c) const { return (Row(r)[c / 64] >> (c % 64)) & 1; }
+	void Set(int r, int c, bool v)
+	{
+		uint64_t& w = bits[static_cast<size_t>(r) * words + c / 64];
+		uint64_t mask = uint64_t(1) << (c % 64);
+		w = v ? w | mask : w & ~mask;
+	}
+private:
+	int rows, cols, words;
+	vector<uint64_t> bits;
+};
+
+struct GridRectangle
+{
+	long long area;
+	int top, bottom;  // rows [top, bottom)
+	int left, right;  // columns [left, right)
+};
+
+// heights[c] = number of consecutive set cells ending at this row. The update
+// is branch-free so the inner loop vectorizes.
+static void accumulateRow(const uint64_t* row, int cols, int* heights)
+{
+	for (int c0 = 0; c0 < cols; c0 += 64)
+	{
+		uint64_t w = row[c0 / 64];
+		int m = min(64, cols - c0);
+		int* h = heights + c0;
+		for (int j = 0; j < m; j++)
+		{
+			int bit = static_cast<int>((w >> j) & 1);
+			h[j] = (h[j] + 1) & -bit;
+		}
+	}
+}
+
+static GridRectangle toGridRectangle(const Rectangle& r, int row)
+{
+	return { r.area, row + 1 - r.height, row + 1,
+		static_cast<int>(r.left), static_cast<int>(r.right) };
+}
+
+// Largest all-set rectangle of the grid.
+GridRectangle maximalRectangle(const BitGrid& grid)
+{
+	vector<int> heights(grid.Cols(), 0);
+	HistogramStream hs;
+	GridRectangle best = { 0, 0, 0, 0, 0 };
+	for (int r = 0; r < grid.Rows(); r++)
+	{
+		accumulateRow(grid.Row(r), grid.Cols(), heights.data());
+		hs.Reset();
+		hs.Feed(heights.begin(), heights.end());
+		Rectangle rect = hs.Finish();
+		if (rect.area > best.area)
+			best = toGridRectangle(rect, r);
+	}
+	return best;
+}
+
+// maximalRectangle over a grid that is edited in place. The best rectangle of
+// every row and the height array every `interval` rows are kept, so a query
+// after an edit only rescans the rows from the checkpoint above it. An
+// interval below 1 is treated as 1.
+class MaximalRectangle
+{
+public:
+	MaximalRectangle(int rows, int cols, int interval = 64)
+		: grid(rows, cols), interval(max(interval, 1)), dirty(0), rowBest(rows),
+		checkpoints((rows + this->interval - 1) / this->interval, vector<int>(cols, 0)) {}
+
+	const BitGrid& Grid() const { return grid; }
+
+	void Set(int r, int c, bool v)
+	{
+		if (grid.Get(r, c) != v)
+		{
+			grid.Set(r, c, v);
+			dirty = min(dirty, r);
+		}
+	}
+
+	GridRectangle Query()
+	{
+		if (dirty < grid.Rows())
+		{
+			int start = dirty / interval * interval;
+			vector<int> heights = checkpoints[start / interval];
+			for (int r = start; r < grid.Rows(); r++)
+			{
+				if (r % interval == 0)
+					checkpoints[r / interval] = heights;
+				accumulateRow(grid.Row(r), grid.Cols(), heights.data());
+				hs.Reset();
+				hs.Feed(heights.begin(), heights.end());
+				rowBest[r] = hs.Finish();
+			}
+			dirty = grid.Rows();
+		}
+		GridRectangle best = { 0, 0, 0, 0, 0 };
+		for (int r = 0; r < grid.Rows(); r++)
+			if (rowBest[r].area > best.area)
+				best = toGridRectangle(rowBest[r], r);
+		return best;
+	}
+
+private:
+	BitGrid grid;
+	int interval;
+	int dirty;  // first row whose rowBest is stale
+	vector<Rectangle> rowBest;
+	vector<vector<int>> checkpoints;  // heights before row k * interval
+	HistogramStream hs;
+};
+
 vector<int> Random(int a, int b)
 {
 
@@ -283,6 +887,18 @@ int main()
 	const char* s = "8+5*6+4^3*4+7/2+6!+9*(2*5+3)";
 	cout << "ʽ: " << s << endl;
 	cout << evaluate(s) << endl;
+	const char* s2 = " -2^2 + 3.5e1 * (1 - -0.5) / 2 ";
+	cout << s2 << " = " << evaluate(s2) << endl;
+	// ЩʽӦڴʷʱ
+	const char* malformed[] = { "1+*2", "1+", "()", "", "2 3", "1.5.3", "2(3)", "(1)(2)", "3!4" };
+	for (const char* m : malformed)
+	{
+		Lexer lexer(m);
+		Token t = lexer.Next();
+		while (t.kind != Token::END && t.kind != Token::INVALID)
+			t = lexer.Next();
+		cout << '"' << m << "\" " << (t.kind == Token::INVALID ? "rejected" : "ACCEPTED") << endl;
+	}
 	for (int i = 0; i < 10; i++)
 	{
 		vector<int> heights = Random(15, 7);
@@ -295,5 +911,48 @@ int main()
 		}
 		cout << endl;
 		cout << "" << largestRectangleArea(heights) << endl;
+		stringstream trace;
+		for (int h : heights)
+			trace << h << ' ';
+		Rectangle r = largestRectangleArea(trace, 4);
+		cout << "stream: " << r.area << " [" << r.left << ", " << r.right << ") x " << r.height << endl;
+	}
+
+	vector<int> big(20000000);
+	for (size_t i = 0; i < big.size(); i++)
+		big[i] = rand() % 100000;
+	auto t0 = chrono::steady_clock::now();
+	HistogramStream hs;
+	hs.Feed(big.begin(), big.end());
+	long long seqArea = hs.Finish().area;
+	auto t1 = chrono::steady_clock::now();
+	long long parArea = largestRectangleAreaParallel(big);
+	auto t2 = chrono::steady_clock::now();
+	cout << "sequential: " << seqArea << " in "
+		<< chrono::duration_cast<chrono::milliseconds>(t1 - t0).count() << " ms" << endl;
+	cout << "parallel:   " << parArea << " in "
+		<< chrono::duration_cast<chrono::milliseconds>(t2 - t1).count() << " ms" << endl;
+
+	const int side = 2000;
+	MaximalRectangle plan(side, side);
+	for (int r = 0; r < side; r++)
+		for (int c = 0; c < side; c++)
+			plan.Set(r, c, rand() % 100 != 0);
+	GridRectangle g = plan.Query();
+	cout << "grid: " << g.area << " rows [" << g.top << ", " << g.bottom
+		<< ") cols [" << g.left << ", " << g.right << ")" << endl;
+	auto t3 = chrono::steady_clock::now();
+	for (int c = 0; c < side; c += 7)
+		plan.Set(side - 10, c, false);
+	g = plan.Query();
+	auto t4 = chrono::steady_clock::now();
+	cout << "after edit: " << g.area << " (full " << maximalRectangle(plan.Grid()).area << ") in "
+		<< chrono::duration_cast<chrono::microseconds>(t4 - t3).count() << " us" << endl;
+
+	cout << "threads\tlock-free\tmutex (ms)" << endl;
+	for (int threads = 1; threads <= 64; threads *= 2)
+	{
+		cout << threads << "\t" << benchConcurrentStack<ConcurrentStack<int>>(threads, 100000)
+			<< "\t\t" << benchConcurrentStack<LockedStack<int>>(threads, 100000) << endl;
 	}
 }
\ No newline at end of file
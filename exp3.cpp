@@ -1,27 +1,46 @@
 #include <iostream>
-#include <queue> 
 #include <vector>
-#include <string>
-#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <mutex>
+#include <queue>
+#include <thread>
 
 using Rank = unsigned int;
 
 template <typename T> struct BinNode;
 template <typename T> using BinNodePosi = BinNode<T>*;
 
+// Hook run whenever a node's subtree summary is recomputed, so that data
+// types can carry their own subtree aggregate (see Keyed below). The default
+// does nothing.
+template <typename T>
+void pullUp(T&, T const*, T const*) {}
+
 template <typename T> struct BinNode
 {
     T data;
     BinNodePosi<T> parent, lc, rc;
     Rank height;
     Rank npl;
+    Rank sz;  // nodes in this subtree, kept current by updateHeight
 
     BinNode(T e, BinNodePosi<T> p = NULL, BinNodePosi<T> lc = NULL,
         BinNodePosi<T> rc = NULL, int h = 0, int l = 1)
-        : data(e), parent(p), lc(lc), rc(rc), height(h), npl(l)
+        : data(e), parent(p), lc(lc), rc(rc), height(h), npl(l), sz(1)
     {
         if (lc) lc->parent = this;
         if (rc) rc->parent = this;
+        if (lc || rc) updateHeight();
     }
 
     Rank size();
@@ -34,37 +53,57 @@ template <typename T> struct BinNode
     BinNodePosi<T> succ();
 
     template <typename VST> void travLevel(VST& visit);
+    template <typename VST> void travLevel(VST& visit, std::vector<BinNodePosi<T>>& queue);
     template <typename VST> void travPre(VST& visit);
     template <typename VST> void travIn(VST& visit);
     template <typename VST> void travPost(VST& visit);
+    template <typename VPre, typename VIn, typename VPost>
+    void travEuler(VPre& pre, VIn& in, VPost& post);
+};
+
+// Visitor that ignores the node, for the unused slots of travEuler.
+struct SkipVisit {
+    template <typename E> void operator()(E&) {}
+};
+
+// Calls several visitors on each node, so that one traversal serves them all:
+//   auto both = fuse(sum, digest); tree.travIn(both);
+template <typename... VST> struct FusedVisit {
+    std::tuple<VST&...> visits;
+    template <typename E> void operator()(E& e) {
+        std::apply([&](VST&... v) { (v(e), ...); }, visits);
+    }
 };
 
+template <typename... VST>
+FusedVisit<VST...> fuse(VST&... visits) { return FusedVisit<VST...>{ std::tie(visits...) }; }
+
 template <typename T>
 Rank BinNode<T>::size()
 {
-    Rank s = 1;
-    if (lc) s += lc->size();
-    if (rc) s += rc->size();
-    return s;
+    return sz;
 }
 
+// Recomputes height, subtree size and the data's aggregate from the children.
 template <typename T>
 Rank BinNode<T>::updateHeight()
 {
-    Rank hl = lc ? lc->height : -1;
-    Rank hr = rc ? rc->height : -1;
-    height = (hl > hr ? hl : hr) + 1;
+    // a leaf has height 0; Rank is unsigned, so no -1 for empty subtrees
+    Rank hl = lc ? lc->height + 1 : 0;
+    Rank hr = rc ? rc->height + 1 : 0;
+    height = hl > hr ? hl : hr;
+    sz = 1 + (lc ? lc->sz : 0) + (rc ? rc->sz : 0);
+    pullUp(data, lc ? &lc->data : NULL, rc ? &rc->data : NULL);
     return height;
 }
 
+// Subtree sizes and aggregates change all the way up, so the walk goes to
+// the root: O(depth).
 template <typename T>
 void BinNode<T>::updateHeightAbove()
 {
-    BinNode<T>* p = this;
-    while (p) {
+    for (BinNode<T>* p = this; p; p = p->parent)
         p->updateHeight();
-        p = p->parent;
-    }
 }
 
 template <typename T>
@@ -115,18 +154,51 @@ BinNode<T>* BinNode<T>::succ()
     return p;
 }
 
+// queue is scratch space; passing the same vector to every call lets its
+// capacity be reused.
 template <typename T>
 template <typename VST>
-void BinNode<T>::travLevel(VST& visit)
+void BinNode<T>::travLevel(VST& visit, std::vector<BinNodePosi<T>>& queue)
 {
-    std::queue<BinNode<T>*> q;
-    q.push(this);
-    while (!q.empty()) {
-        BinNode<T>* node = q.front();
-        q.pop();
+    queue.assign(1, this);
+    for (size_t head = 0; head < queue.size(); head++) {
+        BinNode<T>* node = queue[head];
         visit(node->data);
-        if (node->lc) q.push(node->lc);
-        if (node->rc) q.push(node->rc);
+        if (node->lc) queue.push_back(node->lc);
+        if (node->rc) queue.push_back(node->rc);
+    }
+}
+
+template <typename T>
+template <typename VST>
+void BinNode<T>::travLevel(VST& visit)
+{
+    std::vector<BinNodePosi<T>> queue;
+    travLevel(visit, queue);
+}
+
+// Walks the subtree along child and parent links with O(1) extra space and
+// calls pre, in and post on each node at the matching point of the walk, so
+// all three orders can be produced in a single pass.
+template <typename T>
+template <typename VPre, typename VIn, typename VPost>
+void BinNode<T>::travEuler(VPre& pre, VIn& in, VPost& post)
+{
+    BinNode<T>* x = this;
+    BinNode<T>* prev = parent;
+    for (;;) {
+        if (prev == x->parent) {  // came down
+            pre(x->data);
+            if (x->lc) { prev = x; x = x->lc; continue; }
+        }
+        if (prev == x->parent || prev == x->lc) {  // left subtree done
+            in(x->data);
+            if (x->rc) { prev = x; x = x->rc; continue; }
+        }
+        post(x->data);
+        if (x == this) break;
+        prev = x;
+        x = x->parent;
     }
 }
 
@@ -134,25 +206,30 @@ template <typename T>
 template <typename VST>
 void BinNode<T>::travPre(VST& visit)
 {
-    visit(data);
-    if (lc) lc->travPre(visit);
-    if (rc) rc->travPre(visit);
+    SkipVisit skip;
+    travEuler(visit, skip, skip);
 }
 
+// In-order by repeated succ(), ending at the rightmost node of this subtree.
 template <typename T>
 template <typename VST>
 void BinNode<T>::travIn(VST& visit) {
-    if (lc) lc->travIn(visit);
-    visit(data);
-    if (rc) rc->travIn(visit);
+    BinNode<T>* last = this;
+    while (last->rc) last = last->rc;
+    BinNode<T>* x = this;
+    while (x->lc) x = x->lc;
+    for (;;) {
+        visit(x->data);
+        if (x == last) break;
+        x = x->succ();
+    }
 }
 
 template <typename T>
 template <typename VST>
 void BinNode<T>::travPost(VST& visit) {
-    if (lc) lc->travPost(visit);
-    if (rc) rc->travPost(visit);
-    visit(data);
+    SkipVisit skip;
+    travEuler(skip, skip, visit);
 }
 
 template <typename T> class BinTree
@@ -163,7 +240,7 @@ protected:
 
 public:
     BinTree() : _size(0), _root(NULL) {}
-    ~BinTree() { if (_size > 0) remove(_root); }
+    ~BinTree() { clear(); }
     BinTree(BinTree<T> const&);
     Rank size() const { return _size; }
     bool empty() const { return !_root; }
@@ -174,9 +251,10 @@ public:
     BinNodePosi<T> insert(BinNodePosi<T>, T const&);
     Rank remove(BinNodePosi<T>);
     BinTree<T>* secede(BinNodePosi<T>);
+    void clear();
 
     template <typename VST>
-    void travLevel(VST& visit) { if (_root) _root->travLevel(visit); }
+    void travLevel(VST& visit) { if (_root) _root->travLevel(visit, _queue); }
 
     template <typename VST>
     void travPre(VST& visit) { if (_root) _root->travPre(visit); }
@@ -186,6 +264,12 @@ public:
 
     template <typename VST>
     void travPost(VST& visit) { if (_root) _root->travPost(visit); }
+
+    template <typename VPre, typename VIn, typename VPost>
+    void travEuler(VPre& pre, VIn& in, VPost& post) { if (_root) _root->travEuler(pre, in, post); }
+
+private:
+    std::vector<BinNodePosi<T>> _queue;  // travLevel scratch
 };
 
 template <typename T>
@@ -226,10 +310,13 @@ Rank BinTree<T>::remove(BinNodePosi<T> node) {
     }
     else {
         BinNode<T>* child = node->lc ? node->lc : node->rc;
-        if (child) child->parent = node->parent;
+        BinNode<T>* parent = node->parent;
+        if (child) child->parent = parent;
         if (node == _root) _root = child;
+        else (node == parent->lc ? parent->lc : parent->rc) = child;
         delete node;
         _size--;
+        if (parent) parent->updateHeightAbove();
         return 1;
     }
 }
@@ -238,76 +325,1645 @@ template <typename T>
 BinTree<T>* BinTree<T>::secede(BinNodePosi<T> node) {
     BinTree<T>* newTree = new BinTree<T>();
     newTree->_root = node;
+    newTree->_size = node->size();
+    _size -= node->size();
+    if (node == _root) _root = NULL;
+    else {
+        BinNodePosi<T> parent = node->parent;
+        (node == parent->lc ? parent->lc : parent->rc) = NULL;
+        parent->updateHeightAbove();
+    }
     node->parent = NULL;
     return newTree;
 }
 
+// Frees every node with an explicit stack, so deep (degenerate) trees do
+// not overflow the call stack.
+template <typename T>
+void BinTree<T>::clear() {
+    std::vector<BinNodePosi<T>> stack;
+    if (_root) stack.push_back(_root);
+    while (!stack.empty()) {
+        BinNodePosi<T> x = stack.back();
+        stack.pop_back();
+        if (x->lc) stack.push_back(x->lc);
+        if (x->rc) stack.push_back(x->rc);
+        delete x;
+    }
+    _root = NULL;
+    _size = 0;
+}
+
+// Binary search tree on BinTree: in-order traversal yields the keys sorted.
+// _hot is the parent of the node last reached by search(), which is where
+// insert() hangs a new node and where remove() starts repairing.
+template <typename T> class BST : public BinTree<T>
+{
+protected:
+    BinNodePosi<T> _hot;
+
+    BinNodePosi<T>& fromParentTo(BinNodePosi<T> x) {
+        if (!x->parent) return this->_root;
+        return x == x->parent->lc ? x->parent->lc : x->parent->rc;
+    }
+    BinNodePosi<T> removeAt(BinNodePosi<T>& x);
+    BinNodePosi<T> connect34(BinNodePosi<T>, BinNodePosi<T>, BinNodePosi<T>,
+        BinNodePosi<T>, BinNodePosi<T>, BinNodePosi<T>, BinNodePosi<T>);
+    BinNodePosi<T> rotateAt(BinNodePosi<T> v);
+
+public:
+    BST() : _hot(NULL) {}
+    // The link (root or a child pointer) that holds e, or the NULL link
+    // where e would go.
+    BinNodePosi<T>& search(T const& e);
+    BinNodePosi<T> insert(T const& e);
+    bool remove(T const& e);
+
+    // k-th smallest key (from 0), NULL if k >= size(); O(depth)
+    BinNodePosi<T> select(Rank k) const;
+    // number of keys less than e; O(depth)
+    Rank rank(T const& e) const;
+};
+
+template <typename T>
+BinNodePosi<T> BST<T>::select(Rank k) const
+{
+    BinNodePosi<T> x = this->_root;
+    while (x) {
+        Rank left = x->lc ? x->lc->sz : 0;
+        if (k == left) return x;
+        if (k < left) x = x->lc;
+        else {
+            k -= left + 1;
+            x = x->rc;
+        }
+    }
+    return NULL;
+}
+
+template <typename T>
+Rank BST<T>::rank(T const& e) const
+{
+    Rank r = 0;
+    for (BinNodePosi<T> x = this->_root; x; ) {
+        if (x->data < e) {
+            r += (x->lc ? x->lc->sz : 0) + 1;
+            x = x->rc;
+        }
+        else x = x->lc;
+    }
+    return r;
+}
+
+template <typename T>
+BinNodePosi<T>& BST<T>::search(T const& e)
+{
+    _hot = NULL;
+    if (!this->_root || e == this->_root->data) return this->_root;
+    for (_hot = this->_root;;) {
+        BinNodePosi<T>& v = e < _hot->data ? _hot->lc : _hot->rc;
+        if (!v || e == v->data) return v;
+        _hot = v;
+    }
+}
+
+template <typename T>
+BinNodePosi<T> BST<T>::insert(T const& e)
+{
+    BinNodePosi<T>& x = search(e);
+    if (x) return x;
+    x = new BinNode<T>(e, _hot);
+    this->_size++;
+    if (_hot) _hot->updateHeightAbove();
+    return x;
+}
+
+// Unlinks the node held by x (a node with two children trades data with its
+// successor, which is unlinked instead); sets _hot to the parent of the node
+// actually deleted and returns the node that took its place.
+template <typename T>
+BinNodePosi<T> BST<T>::removeAt(BinNodePosi<T>& x)
+{
+    BinNodePosi<T> w = x;
+    BinNodePosi<T> succ = NULL;
+    if (!x->lc) succ = x = x->rc;
+    else if (!x->rc) succ = x = x->lc;
+    else {
+        w = w->succ();
+        std::swap(x->data, w->data);
+        BinNodePosi<T> u = w->parent;
+        (u == x ? u->rc : u->lc) = succ = w->rc;
+    }
+    _hot = w->parent;
+    if (succ) succ->parent = _hot;
+    delete w;
+    this->_size--;
+    return succ;
+}
+
+template <typename T>
+bool BST<T>::remove(T const& e)
+{
+    BinNodePosi<T>& x = search(e);
+    if (!x) return false;
+    removeAt(x);
+    if (_hot) _hot->updateHeightAbove();
+    return true;
+}
+
+// Links a <= b <= c with subtrees T0..T3 into the balanced shape b(a, c).
+template <typename T>
+BinNodePosi<T> BST<T>::connect34(BinNodePosi<T> a, BinNodePosi<T> b, BinNodePosi<T> c,
+    BinNodePosi<T> T0, BinNodePosi<T> T1, BinNodePosi<T> T2, BinNodePosi<T> T3)
+{
+    a->lc = T0; if (T0) T0->parent = a;
+    a->rc = T1; if (T1) T1->parent = a;
+    a->updateHeight();
+    c->lc = T2; if (T2) T2->parent = c;
+    c->rc = T3; if (T3) T3->parent = c;
+    c->updateHeight();
+    b->lc = a; a->parent = b;
+    b->rc = c; c->parent = b;
+    b->updateHeight();
+    return b;
+}
+
+// Single or double rotation around v, its parent p and grandparent g. The
+// new subtree root is linked to g's old parent and returned.
+template <typename T>
+BinNodePosi<T> BST<T>::rotateAt(BinNodePosi<T> v)
+{
+    BinNodePosi<T> p = v->parent;
+    BinNodePosi<T> g = p->parent;
+    BinNodePosi<T> top = g->parent;
+    BinNodePosi<T>& link = fromParentTo(g);
+    BinNodePosi<T> b;
+    if (p == g->lc) {
+        if (v == p->lc) b = connect34(v, p, g, v->lc, v->rc, p->rc, g->rc);
+        else b = connect34(p, v, g, p->lc, v->lc, v->rc, g->rc);
+    }
+    else {
+        if (v == p->rc) b = connect34(g, p, v, g->lc, p->lc, v->lc, v->rc);
+        else b = connect34(g, v, p, g->lc, v->lc, v->rc, p->rc);
+    }
+    b->parent = top;
+    link = b;
+    return b;
+}
+
+// AVL tree: sibling subtree heights differ by at most one, so search,
+// insert and remove are O(log n). Repairs walk up from _hot to the root,
+// rotating where a node is out of balance and refreshing the others.
+template <typename T> class AVL : public BST<T>
+{
+    static Rank stature(BinNodePosi<T> x) { return x ? x->height + 1 : 0; }
+    static bool balanced(BinNodePosi<T> x) {
+        Rank l = stature(x->lc), r = stature(x->rc);
+        return l <= r + 1 && r <= l + 1;
+    }
+    static BinNodePosi<T> tallerChild(BinNodePosi<T> x) {
+        Rank l = stature(x->lc), r = stature(x->rc);
+        if (l != r) return l > r ? x->lc : x->rc;
+        return x->parent && x == x->parent->lc ? x->lc : x->rc;  // prefer a single rotation
+    }
+
+public:
+    BinNodePosi<T> insert(T const& e);
+    bool remove(T const& e);
+};
+
+template <typename T>
+BinNodePosi<T> AVL<T>::insert(T const& e)
+{
+    BinNodePosi<T>& x = this->search(e);
+    if (x) return x;
+    BinNodePosi<T> xx = x = new BinNode<T>(e, this->_hot);
+    this->_size++;
+    for (BinNodePosi<T> g = this->_hot; g; g = g->parent) {
+        if (!balanced(g)) g = this->rotateAt(tallerChild(tallerChild(g)));
+        else g->updateHeight();
+    }
+    return xx;
+}
+
+template <typename T>
+bool AVL<T>::remove(T const& e)
+{
+    BinNodePosi<T>& x = this->search(e);
+    if (!x) return false;
+    this->removeAt(x);
+    for (BinNodePosi<T> g = this->_hot; g; g = g->parent) {
+        if (!balanced(g)) g = this->rotateAt(tallerChild(tallerChild(g)));
+        else g->updateHeight();
+    }
+    return true;
+}
+
+// Key plus the aggregate of all keys in its subtree under monoid M, which
+// provides Value, identity(), of(key) and an associative combine(a, b).
+// Ordering looks at the key only, so BST<Keyed<K, M>> and AVL<Keyed<K, M>>
+// keep agg current through the pullUp hook.
+template <typename K, typename M> struct Keyed {
+    K key;
+    typename M::Value agg;
+
+    Keyed(K const& k) : key(k), agg(M::of(k)) {}
+    bool operator<(Keyed const& o) const { return key < o.key; }
+    bool operator==(Keyed const& o) const { return key == o.key; }
+};
+
+template <typename K, typename M>
+void pullUp(Keyed<K, M>& e, Keyed<K, M> const* l, Keyed<K, M> const* r)
+{
+    typename M::Value v = M::of(e.key);
+    if (l) v = M::combine(l->agg, v);
+    if (r) v = M::combine(v, r->agg);
+    e.agg = v;
+}
+
+template <typename K> struct SumMonoid {
+    typedef long long Value;
+    static Value identity() { return 0; }
+    static Value of(K const& k) { return k; }
+    static Value combine(Value a, Value b) { return a + b; }
+};
+
+template <typename K> struct MaxMonoid {
+    typedef K Value;
+    static Value identity() { return std::numeric_limits<K>::lowest(); }
+    static Value of(K const& k) { return k; }
+    static Value combine(Value a, Value b) { return a < b ? b : a; }
+};
+
+// Aggregate of the keys in [lo, hi), from the subtree summaries along the two
+// boundary paths below the node where they split; O(depth).
+template <typename K, typename M>
+typename M::Value rangeAggregate(BST<Keyed<K, M>> const& t, K const& lo, K const& hi)
+{
+    BinNodePosi<Keyed<K, M>> s = t.root();
+    while (s && (s->data.key < lo || !(s->data.key < hi)))
+        s = s->data.key < lo ? s->rc : s->lc;
+    if (!s) return M::identity();
+    typename M::Value left = M::identity(), right = M::identity();
+    for (BinNodePosi<Keyed<K, M>> y = s->lc; y; ) {
+        if (y->data.key < lo) y = y->rc;
+        else {
+            left = M::combine(M::combine(M::of(y->data.key), y->rc ? y->rc->data.agg : M::identity()), left);
+            y = y->lc;
+        }
+    }
+    for (BinNodePosi<Keyed<K, M>> z = s->rc; z; ) {
+        if (!(z->data.key < hi)) z = z->lc;
+        else {
+            right = M::combine(right, M::combine(z->lc ? z->lc->data.agg : M::identity(), M::of(z->data.key)));
+            z = z->rc;
+        }
+    }
+    return M::combine(left, M::combine(M::of(s->data.key), right));
+}
+
+// Pointer-free binary tree: nodes sit in one array and link to each other by
+// 32-bit Rank indices. Trees can be grown in place or copied from a BinTree,
+// and compact() reorders the array into breadth-first or van Emde Boas order
+// so that read-mostly traversals touch memory close to the previous node.
+// Traversals visit data in the same orders as BinNode's.
+template <typename T> class CompactBinTree
+{
+public:
+    static const Rank NIL = ~0u;
+    enum Layout { BFS, VEB };
+
+    struct Node {
+        T data;
+        Rank parent, lc, rc;
+    };
+
+    CompactBinTree() : _root(NIL), _bfs(false) {}
+    CompactBinTree(BinTree<T> const& t, Layout layout = BFS);
+    Rank size() const { return static_cast<Rank>(_nodes.size()); }
+    bool empty() const { return _root == NIL; }
+    Rank root() const { return _root; }
+    Node const& node(Rank i) const { return _nodes[i]; }
+
+    Rank insertAsRoot(T const& e);
+    Rank insertLc(Rank p, T const& e);
+    Rank insertRc(Rank p, T const& e);
+    void compact(Layout layout);
+
+    template <typename VST> void travLevel(VST& visit);
+    template <typename VST> void travPre(VST& visit);
+    template <typename VST> void travIn(VST& visit);
+    template <typename VST> void travPost(VST& visit);
+
+private:
+    Rank append(T const& e, Rank p);
+    void orderVEB(Rank r, Rank h, std::vector<Rank>& order);
+
+    std::vector<Node> _nodes;
+    Rank _root;
+    bool _bfs;  // array is in level order
+    std::vector<Rank> _stack;  // traversal scratch, kept between calls
+};
+
+template <typename T>
+Rank CompactBinTree<T>::append(T const& e, Rank p)
+{
+    _nodes.push_back(Node{ e, p, NIL, NIL });
+    _bfs = false;
+    return static_cast<Rank>(_nodes.size() - 1);
+}
+
+template <typename T>
+Rank CompactBinTree<T>::insertAsRoot(T const& e)
+{
+    _nodes.clear();
+    return _root = append(e, NIL);
+}
+
+template <typename T>
+Rank CompactBinTree<T>::insertLc(Rank p, T const& e)
+{
+    Rank i = append(e, p);
+    _nodes[p].lc = i;
+    return i;
+}
+
+template <typename T>
+Rank CompactBinTree<T>::insertRc(Rank p, T const& e)
+{
+    Rank i = append(e, p);
+    _nodes[p].rc = i;
+    return i;
+}
+
+template <typename T>
+CompactBinTree<T>::CompactBinTree(BinTree<T> const& t, Layout layout) : _root(NIL), _bfs(false)
+{
+    if (t.empty()) return;
+    _nodes.reserve(t.size());
+    std::vector<std::pair<BinNodePosi<T>, Rank>> pending;  // (source, copy)
+    pending.push_back({ t.root(), insertAsRoot(t.root()->data) });
+    while (!pending.empty()) {
+        BinNodePosi<T> x = pending.back().first;
+        Rank i = pending.back().second;
+        pending.pop_back();
+        if (x->rc) pending.push_back({ x->rc, insertRc(i, x->rc->data) });
+        if (x->lc) pending.push_back({ x->lc, insertLc(i, x->lc->data) });
+    }
+    compact(layout);
+}
+
+// Appends the subtree of r, cut off below depth h, in van Emde Boas order:
+// the top half of the levels first, then each subtree hanging below it.
+template <typename T>
+void CompactBinTree<T>::orderVEB(Rank r, Rank h, std::vector<Rank>& order)
+{
+    if (h == 1) {
+        order.push_back(r);
+        return;
+    }
+    Rank top = h / 2;
+    orderVEB(r, top, order);
+    std::vector<std::pair<Rank, Rank>> frontier = { { r, 0 } };  // (node, depth)
+    std::vector<Rank> bottoms;
+    while (!frontier.empty()) {
+        Rank x = frontier.back().first, d = frontier.back().second;
+        frontier.pop_back();
+        if (d == top) {
+            bottoms.push_back(x);
+            continue;
+        }
+        if (_nodes[x].rc != NIL) frontier.push_back({ _nodes[x].rc, d + 1 });
+        if (_nodes[x].lc != NIL) frontier.push_back({ _nodes[x].lc, d + 1 });
+    }
+    for (Rank b : bottoms) orderVEB(b, h - top, order);
+}
+
+template <typename T>
+void CompactBinTree<T>::compact(Layout layout)
+{
+    if (_root == NIL) return;
+    std::vector<Rank> order;
+    order.reserve(_nodes.size());
+    if (layout == BFS) {
+        order.push_back(_root);
+        for (size_t head = 0; head < order.size(); head++) {
+            if (_nodes[order[head]].lc != NIL) order.push_back(_nodes[order[head]].lc);
+            if (_nodes[order[head]].rc != NIL) order.push_back(_nodes[order[head]].rc);
+        }
+    }
+    else {
+        // tree height by a level sweep, then the recursive split
+        std::vector<Rank> level = { _root }, next;
+        Rank h = 0;
+        for (; !level.empty(); h++, level.swap(next)) {
+            next.clear();
+            for (Rank x : level) {
+                if (_nodes[x].lc != NIL) next.push_back(_nodes[x].lc);
+                if (_nodes[x].rc != NIL) next.push_back(_nodes[x].rc);
+            }
+        }
+        orderVEB(_root, h, order);
+    }
+
+    std::vector<Rank> where(_nodes.size());
+    for (Rank k = 0; k < order.size(); k++) where[order[k]] = k;
+    std::vector<Node> moved;
+    moved.reserve(order.size());
+    for (Rank x : order) {
+        Node n = _nodes[x];
+        n.parent = n.parent == NIL ? NIL : where[n.parent];
+        n.lc = n.lc == NIL ? NIL : where[n.lc];
+        n.rc = n.rc == NIL ? NIL : where[n.rc];
+        moved.push_back(n);
+    }
+    _nodes.swap(moved);
+    _root = 0;
+    _bfs = layout == BFS;
+}
+
+template <typename T>
+template <typename VST>
+void CompactBinTree<T>::travLevel(VST& visit)
+{
+    if (_root == NIL) return;
+    if (_bfs) {
+        for (Node& n : _nodes) visit(n.data);
+        return;
+    }
+    _stack.assign(1, _root);  // used as a queue
+    for (size_t head = 0; head < _stack.size(); head++) {
+        Node& n = _nodes[_stack[head]];
+        visit(n.data);
+        if (n.lc != NIL) _stack.push_back(n.lc);
+        if (n.rc != NIL) _stack.push_back(n.rc);
+    }
+}
+
+template <typename T>
+template <typename VST>
+void CompactBinTree<T>::travPre(VST& visit)
+{
+    if (_root == NIL) return;
+    _stack.assign(1, _root);
+    while (!_stack.empty()) {
+        Node& n = _nodes[_stack.back()];
+        _stack.pop_back();
+        visit(n.data);
+        if (n.rc != NIL) _stack.push_back(n.rc);
+        if (n.lc != NIL) _stack.push_back(n.lc);
+    }
+}
+
+template <typename T>
+template <typename VST>
+void CompactBinTree<T>::travIn(VST& visit)
+{
+    _stack.clear();
+    Rank x = _root;
+    while (x != NIL || !_stack.empty()) {
+        for (; x != NIL; x = _nodes[x].lc) _stack.push_back(x);
+        x = _stack.back();
+        _stack.pop_back();
+        visit(_nodes[x].data);
+        x = _nodes[x].rc;
+    }
+}
+
+template <typename T>
+template <typename VST>
+void CompactBinTree<T>::travPost(VST& visit)
+{
+    _stack.clear();
+    Rank x = _root, last = NIL;
+    while (x != NIL || !_stack.empty()) {
+        for (; x != NIL; x = _nodes[x].lc) _stack.push_back(x);
+        Node& n = _nodes[_stack.back()];
+        if (n.rc != NIL && n.rc != last) {
+            x = n.rc;
+            continue;
+        }
+        visit(n.data);
+        last = _stack.back();
+        _stack.pop_back();
+    }
+}
+
+// Free-list allocator for BinNodes: memory is taken from the system in
+// chunks and only returned when the pool is destroyed. Not thread-safe; use
+// one pool per thread. adopt() keeps another pool's chunks alive for as long
+// as this one, so nodes can move between structures on different pools.
+template <typename T> class BinNodePool
+{
+public:
+    BinNodePool(size_t chunk = 1024) : _chunk(chunk) {}
+    ~BinNodePool() {
+        for (BinNodePosi<T> c : _chunks) std::allocator<BinNode<T>>().deallocate(c, _chunk);
+    }
+    BinNodePool(BinNodePool const&) = delete;
+    BinNodePool& operator=(BinNodePool const&) = delete;
+
+    BinNodePosi<T> acquire(T const& e) {
+        if (_free.empty()) {
+            BinNodePosi<T> c = std::allocator<BinNode<T>>().allocate(_chunk);
+            _chunks.push_back(c);
+            for (size_t i = _chunk; i-- > 0; ) _free.push_back(c + i);
+        }
+        BinNodePosi<T> x = _free.back();
+        _free.pop_back();
+        return new (x) BinNode<T>(e);
+    }
+    void release(BinNodePosi<T> x) {
+        x->~BinNode<T>();
+        _free.push_back(x);
+    }
+    void adopt(std::shared_ptr<BinNodePool<T>> const& other) { _adopted.push_back(other); }
+
+private:
+    size_t _chunk;
+    std::vector<BinNodePosi<T>> _chunks;
+    std::vector<BinNodePosi<T>> _free;
+    std::vector<std::shared_ptr<BinNodePool<T>>> _adopted;
+};
+
+// Max-heap as a heap-ordered BinTree that supports O(log n) merge.
+// Leftist mode keeps npl(lc) >= npl(rc) in every node, so the right spine
+// that merge walks is O(log n) long; skew mode skips npl and swaps the
+// children of every node on the merge path, for amortized O(log n).
+// Merging walks the two right spines with a loop instead of recursion.
+template <typename T, bool SKEW = false> class MergeableHeap : public BinTree<T>
+{
+public:
+    MergeableHeap(std::shared_ptr<BinNodePool<T>> pool = std::make_shared<BinNodePool<T>>())
+        : _pool(pool) {}
+    ~MergeableHeap() { clear(); }
+    MergeableHeap(MergeableHeap const&) = delete;
+    MergeableHeap& operator=(MergeableHeap const&) = delete;
+
+    void insert(T const& e) {
+        this->_root = merge(this->_root, _pool->acquire(e));
+        this->_size++;
+    }
+    T getMax() const { return this->_root->data; }
+    T delMax();
+    // Moves all of other's elements into this heap, leaving other empty.
+    void merge(MergeableHeap& other);
+    void clear();
+
+private:
+    // nodes belong to _pool, so BinTree's delete-based removal must not be reachable
+    using BinTree<T>::remove;
+    using BinTree<T>::secede;
+
+    BinNodePosi<T> merge(BinNodePosi<T> a, BinNodePosi<T> b);
+
+    std::shared_ptr<BinNodePool<T>> _pool;
+    std::vector<BinNodePosi<T>> _path;  // merge scratch
+};
+
+template <typename T> using LeftHeap = MergeableHeap<T, false>;
+template <typename T> using SkewHeap = MergeableHeap<T, true>;
+
+template <typename T, bool SKEW>
+BinNodePosi<T> MergeableHeap<T, SKEW>::merge(BinNodePosi<T> a, BinNodePosi<T> b)
+{
+    BinNodePosi<T> root = NULL;
+    BinNodePosi<T>* slot = &root;
+    BinNodePosi<T> parent = NULL;
+    _path.clear();
+    while (a && b) {
+        if (a->data < b->data) std::swap(a, b);
+        *slot = a;
+        a->parent = parent;
+        _path.push_back(a);
+        parent = a;
+        slot = &a->rc;
+        a = a->rc;
+    }
+    *slot = a ? a : b;
+    if (*slot) (*slot)->parent = parent;
+    for (size_t i = _path.size(); i-- > 0; ) {
+        BinNodePosi<T> x = _path[i];
+        if (SKEW) std::swap(x->lc, x->rc);
+        else {
+            if (!x->lc || (x->rc && x->lc->npl < x->rc->npl)) std::swap(x->lc, x->rc);
+            x->npl = x->rc ? x->rc->npl + 1 : 1;
+        }
+    }
+    return root;
+}
+
+template <typename T, bool SKEW>
+T MergeableHeap<T, SKEW>::delMax()
+{
+    BinNodePosi<T> top = this->_root;
+    BinNodePosi<T> lc = top->lc, rc = top->rc;
+    if (lc) lc->parent = NULL;
+    if (rc) rc->parent = NULL;
+    T e = top->data;
+    _pool->release(top);
+    this->_root = merge(lc, rc);
+    this->_size--;
+    return e;
+}
+
+template <typename T, bool SKEW>
+void MergeableHeap<T, SKEW>::merge(MergeableHeap& other)
+{
+    if (this == &other) return;
+    if (_pool != other._pool) _pool->adopt(other._pool);
+    this->_root = merge(this->_root, other._root);
+    this->_size += other._size;
+    other._root = NULL;
+    other._size = 0;
+}
+
+template <typename T, bool SKEW>
+void MergeableHeap<T, SKEW>::clear()
+{
+    if (this->_root) _path.assign(1, this->_root);
+    while (!_path.empty() && this->_root) {
+        BinNodePosi<T> x = _path.back();
+        _path.pop_back();
+        if (x->lc) _path.push_back(x->lc);
+        if (x->rc) _path.push_back(x->rc);
+        _pool->release(x);
+    }
+    this->_root = NULL;
+    this->_size = 0;
+}
+
 void visit(int data) {
     std::cout << data << " ";
 }
 
-struct HuffNode {
-    char data;
-    int freq;
-    HuffNode* left;
-    HuffNode* right;
+// Order-sensitive checksum, to compare traversals without printing them.
+struct Digest {
+    unsigned long long h = 0;
+    void operator()(int data) { h = h * 1000003 + data; }
+};
+
+// Code tables shared by HuffTree and the codec below. A code is stored
+// bit-reversed so that it can be packed LSB first.
+const int HUFF_SYMBOLS = 256;
+const int HUFF_MAX_LEN = 15;
 
-    HuffNode(char d, int f) : data(d), freq(f), left(nullptr), right(nullptr) {}
+struct HuffCode {
+    uint32_t bits;
+    uint8_t len;
 };
 
-struct Compare {
-    bool operator()(HuffNode* left, HuffNode* right) {
-        return left->freq > right->freq;
+uint32_t reverseBits(uint32_t code, int len) {
+    uint32_t r = 0;
+    for (int i = 0; i < len; i++) {
+        r = (r << 1) | (code & 1);
+        code >>= 1;
+    }
+    return r;
+}
+
+// Assigns canonical codes: shorter codes first, ties broken by symbol value.
+// Returns false if the lengths over-subscribe the code space.
+bool canonicalCodes(const uint8_t lens[HUFF_SYMBOLS], HuffCode codes[HUFF_SYMBOLS]) {
+    uint32_t count[HUFF_MAX_LEN + 1] = { 0 };
+    for (int s = 0; s < HUFF_SYMBOLS; s++) {
+        if (lens[s] > HUFF_MAX_LEN) return false;
+        count[lens[s]]++;
+    }
+    count[0] = 0;
+    uint32_t next[HUFF_MAX_LEN + 1] = { 0 };
+    uint32_t code = 0;
+    for (int len = 1; len <= HUFF_MAX_LEN; len++) {
+        code = (code + count[len - 1]) << 1;
+        next[len] = code;
+        if (next[len] + count[len] > (1u << len)) return false;
+    }
+    for (int s = 0; s < HUFF_SYMBOLS; s++) {
+        codes[s].len = lens[s];
+        codes[s].bits = lens[s] ? reverseBits(next[lens[s]]++, lens[s]) : 0;
+    }
+    return true;
+}
+
+// Reshapes a full code tree, given as the number of leaves at each depth,
+// so that no leaf is deeper than maxLen: the two deepest leaves are removed,
+// their parent becomes a leaf, and a shallower leaf is split in two (the
+// JPEG Annex K.3 adjustment). The tree stays full.
+void limitCodeLengths(std::vector<uint32_t>& count, int maxLen) {
+    for (int i = static_cast<int>(count.size()) - 1; i > maxLen; i--) {
+        while (count[i] > 0) {
+            int j = i - 2;
+            while (count[j] == 0) j--;
+            count[i] -= 2;
+            count[i - 1] += 1;
+            count[j + 1] += 2;
+            count[j] -= 1;
+        }
     }
+}
+
+// Children are indices into the owning HuffTree's node array, -1 for none.
+struct HuffNode {
+    char data;
+    int freq;
+    int left;
+    int right;
+
+    HuffNode(char d, int f, int l = -1, int r = -1) : data(d), freq(f), left(l), right(r) {}
 };
 
+// All nodes live in one array that is cleared, not freed, between builds.
+// Leaves are sorted once by frequency and occupy the front of the array;
+// merged nodes are appended behind them in nondecreasing frequency, so the
+// two sorted runs act as the two queues of the linear-time Huffman merge.
 class HuffTree {
 private:
-    HuffNode* root;
+    std::vector<HuffNode> nodes;
+    int root;
+    std::vector<std::pair<int, int>> stack;  // scratch for codeLengths
+    std::vector<int> leaves;
 
-    void generateCodes(HuffNode* node, const std::string& code, std::unordered_map<char, std::string>& huffmanCodes) {
-        if (!node) return;
-        if (!node->left && !node->right) {
-            huffmanCodes[node->data] = code;
+    void merge() {
+        std::sort(nodes.begin(), nodes.end(), [](const HuffNode& a, const HuffNode& b) {
+            return a.freq != b.freq ? a.freq < b.freq : static_cast<uint8_t>(a.data) < static_cast<uint8_t>(b.data);
+        });
+        int n = static_cast<int>(nodes.size());
+        root = n ? 0 : -1;
+        if (n < 2) return;
+        int leaf = 0, inner = n;
+        auto takeMin = [&]() {
+            if (leaf < n && (inner == static_cast<int>(nodes.size()) || nodes[leaf].freq <= nodes[inner].freq))
+                return leaf++;
+            return inner++;
+        };
+        for (int k = 1; k < n; k++) {
+            int a = takeMin();
+            int b = takeMin();
+            nodes.push_back(HuffNode('\0', nodes[a].freq + nodes[b].freq, a, b));
         }
-        generateCodes(node->left, code + "0", huffmanCodes);
-        generateCodes(node->right, code + "1", huffmanCodes);
+        root = static_cast<int>(nodes.size()) - 1;
     }
 
 public:
-    HuffTree() : root(nullptr) {}
+    HuffTree() : root(-1) {}
 
     void build(const std::vector<std::pair<char, int>>& charFreqs) {
-        std::priority_queue<HuffNode*, std::vector<HuffNode*>, Compare> pq;
+        nodes.clear();
+        nodes.reserve(2 * charFreqs.size());
         for (const auto& cf : charFreqs) {
-            pq.push(new HuffNode(cf.first, cf.second));
+            nodes.push_back(HuffNode(cf.first, cf.second));
+        }
+        merge();
+    }
+
+    // Builds over the nonzero byte counts, scaled into HuffNode's int range.
+    void build(const uint64_t freqs[HUFF_SYMBOLS]) {
+        uint64_t total = 0;
+        for (int s = 0; s < HUFF_SYMBOLS; s++) total += freqs[s];
+        int shift = 0;
+        while ((total >> shift) > INT_MAX / 2) shift++;
+        nodes.clear();
+        nodes.reserve(2 * HUFF_SYMBOLS);
+        for (int s = 0; s < HUFF_SYMBOLS; s++) {
+            if (freqs[s]) {
+                nodes.push_back(HuffNode(static_cast<char>(s), std::max<int>(1, static_cast<int>(freqs[s] >> shift))));
+            }
+        }
+        merge();
+    }
+
+    // Leaf depths by an explicit-stack walk, limited to maxLen bits. When the
+    // limit bites, the limited lengths go to the leaves in order of
+    // decreasing frequency.
+    void codeLengths(uint8_t lens[HUFF_SYMBOLS], int maxLen = HUFF_MAX_LEN) {
+        std::fill(lens, lens + HUFF_SYMBOLS, 0);
+        if (root < 0) return;
+        if (nodes[root].left < 0) {
+            lens[static_cast<uint8_t>(nodes[root].data)] = 1;
+            return;
+        }
+        stack.assign(1, { root, 0 });
+        leaves.clear();
+        std::vector<uint32_t> count(1, 0);
+        while (!stack.empty()) {
+            const HuffNode& node = nodes[stack.back().first];
+            int depth = stack.back().second;
+            stack.pop_back();
+            if (node.left >= 0) {
+                stack.push_back({ node.left, depth + 1 });
+                stack.push_back({ node.right, depth + 1 });
+                continue;
+            }
+            lens[static_cast<uint8_t>(node.data)] = static_cast<uint8_t>(depth);
+            if (count.size() <= static_cast<size_t>(depth)) count.resize(depth + 1, 0);
+            count[depth]++;
         }
-        while (pq.size() > 1) {
-            HuffNode* left = pq.top(); pq.pop();
-            HuffNode* right = pq.top(); pq.pop();
-            HuffNode* newNode = new HuffNode('\0', left->freq + right->freq);
-            newNode->left = left;
-            newNode->right = right;
-            pq.push(newNode);
+        if (count.size() <= static_cast<size_t>(maxLen) + 1) return;
+
+        // leaves sit at the front of the array in increasing frequency
+        limitCodeLengths(count, maxLen);
+        int k = static_cast<int>(nodes.size() + 1) / 2;
+        for (int len = 1; len <= maxLen; len++) {
+            for (uint32_t c = 0; c < count[len]; c++) lens[static_cast<uint8_t>(nodes[--k].data)] = static_cast<uint8_t>(len);
         }
-        root = pq.top();
+    }
+
+    void generateCodes(HuffCode codes[HUFF_SYMBOLS]) {
+        uint8_t lens[HUFF_SYMBOLS];
+        codeLengths(lens);
+        canonicalCodes(lens, codes);
     }
 
     void displayHuffmanCodes() {
-        std::unordered_map<char, std::string> huffmanCodes;
-        generateCodes(root, "", huffmanCodes);
-        for (const auto& code : huffmanCodes) {
-            std::cout << code.first << ": " << code.second << "\n";
+        HuffCode codes[HUFF_SYMBOLS];
+        generateCodes(codes);
+        for (int s = 0; s < HUFF_SYMBOLS; s++) {
+            if (!codes[s].len) continue;
+            std::cout << static_cast<char>(s) << ": ";
+            for (int i = 0; i < codes[s].len; i++) std::cout << ((codes[s].bits >> i) & 1);
+            std::cout << "\n";
+        }
+    }
+};
+
+// Byte-oriented Huffman codec. Only the code lengths are taken from HuffTree;
+// the codes themselves are canonical, so the header is just one 4-bit length
+// per byte value. Codes are stored bit-reversed and packed LSB first, which
+// lets the decoder index a lookup table with the low bits of its buffer.
+//
+// Stream layout: 8-byte little-endian original size, 128 bytes of packed code
+// lengths (low nibble = even symbol), then the packed codes.
+const int HUFF_TABLE_BITS = 11;
+const size_t HUFF_HEADER_SIZE = 8 + HUFF_SYMBOLS / 2;
+
+void countFrequencies(const uint8_t* data, size_t n, uint64_t freqs[HUFF_SYMBOLS]) {
+    // four interleaved histograms keep runs of one byte value from
+    // serializing on the same counter
+    std::vector<uint32_t> hist(4 * HUFF_SYMBOLS, 0);
+    std::fill(freqs, freqs + HUFF_SYMBOLS, 0);
+    size_t i = 0;
+    while (i < n) {
+        size_t end = i + std::min<size_t>(n - i, size_t(1) << 30);
+        for (; i + 4 <= end; i += 4) {
+            hist[data[i]]++;
+            hist[HUFF_SYMBOLS + data[i + 1]]++;
+            hist[2 * HUFF_SYMBOLS + data[i + 2]]++;
+            hist[3 * HUFF_SYMBOLS + data[i + 3]]++;
+        }
+        for (; i < end; i++) hist[data[i]]++;
+        for (int s = 0; s < HUFF_SYMBOLS; s++) {
+            freqs[s] += uint64_t(hist[s]) + hist[HUFF_SYMBOLS + s] +
+                hist[2 * HUFF_SYMBOLS + s] + hist[3 * HUFF_SYMBOLS + s];
+            hist[s] = hist[HUFF_SYMBOLS + s] = hist[2 * HUFF_SYMBOLS + s] = hist[3 * HUFF_SYMBOLS + s] = 0;
         }
     }
+}
+
+// Length-limited code lengths for the given byte counts. The tree is passed
+// in so that callers coding many blocks reuse its node array.
+void huffCodeLengths(const uint64_t freqs[HUFF_SYMBOLS], uint8_t lens[HUFF_SYMBOLS], HuffTree& tree) {
+    tree.build(freqs);
+    tree.codeLengths(lens);
+}
+
+void huffCodeLengths(const uint64_t freqs[HUFF_SYMBOLS], uint8_t lens[HUFF_SYMBOLS]) {
+    HuffTree tree;
+    huffCodeLengths(freqs, lens, tree);
+}
+
+class BitWriter {
+public:
+    BitWriter(uint8_t* dst) : dst(dst), acc(0), nbits(0) {}
+
+    // len <= 32
+    void put(uint32_t bits, int len) {
+        acc |= uint64_t(bits) << nbits;
+        nbits += len;
+        if (nbits >= 32) {
+            for (int k = 0; k < 4; k++) *dst++ = static_cast<uint8_t>(acc >> (8 * k));
+            acc >>= 32;
+            nbits -= 32;
+        }
+    }
+
+    // Continues writing at p, keeping the bits still in the accumulator.
+    void retarget(uint8_t* p) { dst = p; }
+    uint8_t* position() const { return dst; }
+
+    // Pads the last byte with zeros; returns one past the last byte written.
+    uint8_t* flush() {
+        for (; nbits > 0; nbits -= 8) {
+            *dst++ = static_cast<uint8_t>(acc);
+            acc >>= 8;
+        }
+        nbits = 0;
+        return dst;
+    }
+
+private:
+    uint8_t* dst;
+    uint64_t acc;
+    int nbits;
 };
 
+class BitReader {
+public:
+    BitReader(const uint8_t* src, size_t n) : src(src), n(n), pos(0), acc(0), nbits(0) {}
+
+    // Tops the buffer up to at least 56 bits; reads past the end yield zeros.
+    void refill() {
+        if (pos + 8 <= n) {
+            // one 8-byte load; a partially taken byte is simply loaded again
+            uint64_t w = 0;
+            for (int k = 0; k < 8; k++) w |= uint64_t(src[pos + k]) << (8 * k);
+            acc |= w << nbits;
+            pos += (63 - nbits) >> 3;
+            nbits |= 56;
+            return;
+        }
+        for (; nbits <= 56; nbits += 8, pos++) {
+            acc |= uint64_t(pos < n ? src[pos] : 0) << nbits;
+        }
+    }
+    uint32_t peek(int len) const { return static_cast<uint32_t>(acc & ((uint64_t(1) << len) - 1)); }
+    void consume(int len) { acc >>= len; nbits -= len; }
+    // True if no bits beyond the end of the input have been consumed.
+    bool inBounds() const { return pos <= n || (pos - n) * 8 <= size_t(nbits); }
+
+private:
+    const uint8_t* src;
+    size_t n;
+    size_t pos;
+    uint64_t acc;
+    int nbits;
+};
+
+// Table-driven decoder: codes up to HUFF_TABLE_BITS long resolve with one
+// lookup; the rare longer codes fall back to a canonical per-length search.
+class HuffDecoder {
+public:
+    bool init(const uint8_t lens[HUFF_SYMBOLS]) {
+        HuffCode codes[HUFF_SYMBOLS];
+        if (!canonicalCodes(lens, codes)) return false;
+        std::fill(table, table + (1 << HUFF_TABLE_BITS), 0);
+        for (int s = 0; s < HUFF_SYMBOLS; s++) {
+            if (codes[s].len && codes[s].len <= HUFF_TABLE_BITS) {
+                for (uint32_t i = codes[s].bits; i < (1u << HUFF_TABLE_BITS); i += 1u << codes[s].len)
+                    table[i] = static_cast<uint16_t>(s << 4 | codes[s].len);
+            }
+        }
+        int k = 0;
+        uint32_t code = 0;
+        for (int len = 1; len <= HUFF_MAX_LEN; len++) {
+            first[len] = code;
+            offset[len] = k;
+            count[len] = 0;
+            for (int s = 0; s < HUFF_SYMBOLS; s++) {
+                if (lens[s] == len) {
+                    sorted[k++] = static_cast<uint8_t>(s);
+                    count[len]++;
+                }
+            }
+            code = (code + count[len]) << 1;
+        }
+        return true;
+    }
+
+    // The reader must hold at least HUFF_MAX_LEN bits. Returns -1 on a code
+    // that is not in the table.
+    int decode(BitReader& in) const {
+        uint16_t e = table[in.peek(HUFF_TABLE_BITS)];
+        if (e) {
+            in.consume(e & 15);
+            return e >> 4;
+        }
+        uint32_t bits = in.peek(HUFF_MAX_LEN);
+        uint32_t code = 0;
+        for (int len = 1; len <= HUFF_MAX_LEN; len++) {
+            code = (code << 1) | ((bits >> (len - 1)) & 1);
+            if (code - first[len] < count[len]) {
+                in.consume(len);
+                return sorted[offset[len] + code - first[len]];
+            }
+        }
+        return -1;
+    }
+
+private:
+    uint16_t table[1 << HUFF_TABLE_BITS];  // symbol << 4 | length, 0 = long code
+    uint32_t first[HUFF_MAX_LEN + 1];
+    uint32_t count[HUFF_MAX_LEN + 1];
+    int offset[HUFF_MAX_LEN + 1];
+    uint8_t sorted[HUFF_SYMBOLS];
+};
+
+// Packs data with the given codes; dst needs room for n * HUFF_MAX_LEN / 8 + 8
+// bytes. Two codes are merged into one accumulator write.
+uint8_t* huffPack(const uint8_t* data, size_t n, const HuffCode codes[HUFF_SYMBOLS], uint8_t* dst) {
+    BitWriter out(dst);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const HuffCode& a = codes[data[i]];
+        const HuffCode& b = codes[data[i + 1]];
+        out.put(a.bits | b.bits << a.len, a.len + b.len);
+    }
+    if (i < n) out.put(codes[data[i]].bits, codes[data[i]].len);
+    return out.flush();
+}
+
+// Decodes n symbols; returns false on a corrupt or truncated stream.
+bool huffUnpack(const uint8_t* src, size_t srcLen, const HuffDecoder& dec, uint8_t* out, size_t n) {
+    BitReader in(src, srcLen);
+    uint8_t* end = out + n;
+    // 56 buffered bits always cover three codes
+    while (end - out >= 3) {
+        in.refill();
+        int s0 = dec.decode(in);
+        int s1 = dec.decode(in);
+        int s2 = dec.decode(in);
+        if ((s0 | s1 | s2) < 0) return false;
+        out[0] = static_cast<uint8_t>(s0);
+        out[1] = static_cast<uint8_t>(s1);
+        out[2] = static_cast<uint8_t>(s2);
+        out += 3;
+    }
+    while (out < end) {
+        in.refill();
+        int s = dec.decode(in);
+        if (s < 0) return false;
+        *out++ = static_cast<uint8_t>(s);
+    }
+    return in.inBounds();
+}
+
+void putLE(uint8_t* dst, uint64_t v, int bytes) {
+    for (int k = 0; k < bytes; k++) dst[k] = static_cast<uint8_t>(v >> (8 * k));
+}
+
+uint64_t getLE(const uint8_t* src, int bytes) {
+    uint64_t v = 0;
+    for (int k = 0; k < bytes; k++) v |= uint64_t(src[k]) << (8 * k);
+    return v;
+}
+
+// Code lengths as 128 bytes, low nibble = even symbol.
+void packLengths(const uint8_t lens[HUFF_SYMBOLS], uint8_t* dst) {
+    for (int s = 0; s < HUFF_SYMBOLS; s += 2) dst[s / 2] = static_cast<uint8_t>(lens[s] | lens[s + 1] << 4);
+}
+
+void unpackLengths(const uint8_t* src, uint8_t lens[HUFF_SYMBOLS]) {
+    for (int s = 0; s < HUFF_SYMBOLS; s += 2) {
+        lens[s] = src[s / 2] & 15;
+        lens[s + 1] = src[s / 2] >> 4;
+    }
+}
+
+std::vector<uint8_t> huffmanEncode(const uint8_t* data, size_t n) {
+    uint64_t freqs[HUFF_SYMBOLS];
+    uint8_t lens[HUFF_SYMBOLS];
+    HuffCode codes[HUFF_SYMBOLS];
+    countFrequencies(data, n, freqs);
+    huffCodeLengths(freqs, lens);
+    canonicalCodes(lens, codes);
+
+    std::vector<uint8_t> out(HUFF_HEADER_SIZE + n * HUFF_MAX_LEN / 8 + 8);
+    putLE(out.data(), n, 8);
+    packLengths(lens, out.data() + 8);
+    uint8_t* end = huffPack(data, n, codes, out.data() + HUFF_HEADER_SIZE);
+    out.resize(end - out.data());
+    return out;
+}
+
+bool huffmanDecode(const uint8_t* src, size_t srcLen, std::vector<uint8_t>& out) {
+    if (srcLen < HUFF_HEADER_SIZE) return false;
+    uint64_t n = getLE(src, 8);
+    uint8_t lens[HUFF_SYMBOLS];
+    unpackLengths(src + 8, lens);
+    // every code is at least one bit, which bounds n before allocating
+    if (n > (srcLen - HUFF_HEADER_SIZE) * 8) return false;
+    HuffDecoder dec;
+    if (!dec.init(lens)) return false;
+    out.resize(n);
+    return huffUnpack(src + HUFF_HEADER_SIZE, srcLen - HUFF_HEADER_SIZE, dec, out.data(), n);
+}
+
+bool readFile(const char* path, std::vector<uint8_t>& data) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool writeFile(const char* path, const std::vector<uint8_t>& data) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return static_cast<bool>(out);
+}
+
+bool huffmanCompressFile(const char* inPath, const char* outPath) {
+    std::vector<uint8_t> data;
+    return readFile(inPath, data) && writeFile(outPath, huffmanEncode(data.data(), data.size()));
+}
+
+bool huffmanDecompressFile(const char* inPath, const char* outPath) {
+    std::vector<uint8_t> packed, data;
+    return readFile(inPath, packed) && huffmanDecode(packed.data(), packed.size(), data) && writeFile(outPath, data);
+}
+
+// Block container: the input is cut into fixed-size blocks that are coded
+// independently, either each with its own code table or all with one shared
+// table, and an offset index lets any block be decoded on its own.
+//
+// Layout: "HUFB", u32 block size, u64 total size, u32 flags (bit 0 = shared
+// table), the shared table's 128 length bytes if present, (blocks + 1) u64
+// offsets into the payload, then the payload. A block without the shared
+// table starts with its own 128 length bytes. A block size below 1 is
+// treated as 1, since the decoder rejects 0.
+const uint32_t HUFF_SHARED_TABLE = 1;
+
+struct HuffContainer {
+    uint32_t blockSize;
+    uint64_t total;
+    size_t blocks;
+    bool shared;
+    uint8_t lens[HUFF_SYMBOLS];  // shared table
+    const uint8_t* offsets;
+    const uint8_t* payload;
+    size_t payloadLen;
+
+    size_t blockLen(size_t b) const { return static_cast<size_t>(std::min<uint64_t>(blockSize, total - uint64_t(b) * blockSize)); }
+};
+
+// Runs worker on `threads` threads, the calling thread included.
+template <typename F>
+void runParallel(unsigned threads, F worker) {
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for (std::thread& t : pool) t.join();
+}
+
+std::vector<uint8_t> huffmanEncodeBlocks(const uint8_t* data, size_t n, uint32_t blockSize = 1 << 20,
+    bool shared = false, unsigned threads = 0) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    blockSize = std::max<uint32_t>(blockSize, 1);
+    size_t blocks = (n + blockSize - 1) / blockSize;
+    std::atomic<size_t> next(0);
+
+    uint8_t sharedLens[HUFF_SYMBOLS] = { 0 };
+    if (shared) {
+        std::vector<uint64_t> freqs(HUFF_SYMBOLS, 0);
+        std::mutex m;
+        runParallel(threads, [&]() {
+            uint64_t local[HUFF_SYMBOLS], part[HUFF_SYMBOLS];
+            std::fill(local, local + HUFF_SYMBOLS, 0);
+            for (size_t b; (b = next++) < blocks; ) {
+                size_t begin = b * blockSize;
+                countFrequencies(data + begin, std::min<size_t>(blockSize, n - begin), part);
+                for (int s = 0; s < HUFF_SYMBOLS; s++) local[s] += part[s];
+            }
+            std::lock_guard<std::mutex> lock(m);
+            for (int s = 0; s < HUFF_SYMBOLS; s++) freqs[s] += local[s];
+        });
+        huffCodeLengths(freqs.data(), sharedLens);
+        next = 0;
+    }
+    HuffCode sharedCodes[HUFF_SYMBOLS];
+    canonicalCodes(sharedLens, sharedCodes);
+
+    std::vector<std::vector<uint8_t>> packed(blocks);
+    runParallel(threads, [&]() {
+        HuffTree tree;
+        uint64_t freqs[HUFF_SYMBOLS];
+        uint8_t lens[HUFF_SYMBOLS];
+        HuffCode codes[HUFF_SYMBOLS];
+        for (size_t b; (b = next++) < blocks; ) {
+            size_t begin = b * blockSize;
+            size_t len = std::min<size_t>(blockSize, n - begin);
+            std::vector<uint8_t>& out = packed[b];
+            size_t head = shared ? 0 : HUFF_SYMBOLS / 2;
+            out.resize(head + len * HUFF_MAX_LEN / 8 + 8);
+            const HuffCode* use = sharedCodes;
+            if (!shared) {
+                countFrequencies(data + begin, len, freqs);
+                huffCodeLengths(freqs, lens, tree);
+                canonicalCodes(lens, codes);
+                packLengths(lens, out.data());
+                use = codes;
+            }
+            uint8_t* end = huffPack(data + begin, len, use, out.data() + head);
+            out.resize(end - out.data());
+        }
+    });
+
+    size_t indexAt = 20 + (shared ? HUFF_SYMBOLS / 2 : 0);
+    size_t payloadAt = indexAt + 8 * (blocks + 1);
+    size_t total = payloadAt;
+    for (const std::vector<uint8_t>& p : packed) total += p.size();
+    std::vector<uint8_t> out(total);
+    memcpy(out.data(), "HUFB", 4);
+    putLE(out.data() + 4, blockSize, 4);
+    putLE(out.data() + 8, n, 8);
+    putLE(out.data() + 16, shared ? HUFF_SHARED_TABLE : 0, 4);
+    if (shared) packLengths(sharedLens, out.data() + 20);
+    uint64_t offset = 0;
+    for (size_t b = 0; b <= blocks; b++) {
+        putLE(out.data() + indexAt + 8 * b, offset, 8);
+        if (b < blocks) {
+            if (!packed[b].empty()) memcpy(out.data() + payloadAt + offset, packed[b].data(), packed[b].size());
+            offset += packed[b].size();
+            std::vector<uint8_t>().swap(packed[b]);
+        }
+    }
+    return out;
+}
+
+bool parseHuffContainer(const uint8_t* src, size_t srcLen, HuffContainer& c) {
+    if (srcLen < 20 || memcmp(src, "HUFB", 4) != 0) return false;
+    c.blockSize = static_cast<uint32_t>(getLE(src + 4, 4));
+    c.total = getLE(src + 8, 8);
+    c.shared = (getLE(src + 16, 4) & HUFF_SHARED_TABLE) != 0;
+    if (c.blockSize == 0) return false;
+    uint64_t blocks = (c.total + c.blockSize - 1) / c.blockSize;
+    size_t indexAt = 20 + (c.shared ? HUFF_SYMBOLS / 2 : 0);
+    if (srcLen < indexAt || blocks >= (srcLen - indexAt) / 8) return false;
+    c.blocks = static_cast<size_t>(blocks);
+    std::fill(c.lens, c.lens + HUFF_SYMBOLS, 0);
+    if (c.shared) unpackLengths(src + 20, c.lens);
+    c.offsets = src + indexAt;
+    c.payload = c.offsets + 8 * (c.blocks + 1);
+    c.payloadLen = srcLen - (c.payload - src);
+    // every code is at least one bit, which bounds the size before allocating
+    return getLE(c.offsets + 8 * c.blocks, 8) <= c.payloadLen && c.total <= uint64_t(c.payloadLen) * 8;
+}
+
+// Decodes block b into out, which must hold c.blockLen(b) bytes. A decoder
+// built from the shared table may be passed in to skip rebuilding it.
+bool huffmanDecodeBlock(const HuffContainer& c, size_t b, uint8_t* out, const HuffDecoder* sharedDec = nullptr) {
+    if (b >= c.blocks) return false;
+    uint64_t begin = getLE(c.offsets + 8 * b, 8);
+    uint64_t end = getLE(c.offsets + 8 * (b + 1), 8);
+    if (begin > end || end > c.payloadLen) return false;
+    const uint8_t* src = c.payload + begin;
+    size_t len = static_cast<size_t>(end - begin);
+    HuffDecoder dec;
+    if (c.shared) {
+        if (!sharedDec) {
+            if (!dec.init(c.lens)) return false;
+            sharedDec = &dec;
+        }
+    }
+    else {
+        uint8_t lens[HUFF_SYMBOLS];
+        if (len < HUFF_SYMBOLS / 2) return false;
+        unpackLengths(src, lens);
+        if (!dec.init(lens)) return false;
+        sharedDec = &dec;
+        src += HUFF_SYMBOLS / 2;
+        len -= HUFF_SYMBOLS / 2;
+    }
+    return huffUnpack(src, len, *sharedDec, out, c.blockLen(b));
+}
+
+bool huffmanDecodeBlock(const uint8_t* src, size_t srcLen, size_t b, std::vector<uint8_t>& out) {
+    HuffContainer c;
+    if (!parseHuffContainer(src, srcLen, c) || b >= c.blocks) return false;
+    out.resize(c.blockLen(b));
+    return huffmanDecodeBlock(c, b, out.data());
+}
+
+bool huffmanDecodeBlocks(const uint8_t* src, size_t srcLen, std::vector<uint8_t>& out, unsigned threads = 0) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    HuffContainer c;
+    if (!parseHuffContainer(src, srcLen, c)) return false;
+    HuffDecoder shared;
+    if (c.shared && c.blocks && !shared.init(c.lens)) return false;
+    out.resize(static_cast<size_t>(c.total));
+    std::atomic<size_t> next(0);
+    std::atomic<bool> ok(true);
+    runParallel(threads, [&]() {
+        for (size_t b; ok && (b = next++) < c.blocks; ) {
+            if (!huffmanDecodeBlock(c, b, out.data() + b * c.blockSize, c.shared ? &shared : nullptr)) ok = false;
+        }
+    });
+    return ok;
+}
+
+// Adaptive mode for streams whose statistics are not known in advance.
+// Encoder and decoder start from a flat code and apply the same updates:
+// every coded symbol bumps its count, and the code is rebuilt after 64, 128,
+// ... symbols, then every `interval` symbols. Before a rebuild the counts are
+// halved once they sum past `window`, so old data fades out. No code table is
+// transmitted and memory stays constant.
+class AdaptiveHuffModel {
+public:
+    AdaptiveHuffModel(uint32_t interval, uint32_t window, bool decoding)
+        : interval(std::max<uint32_t>(interval, 1)), window(window), decoding(decoding), step(64), seen(0), total(HUFF_SYMBOLS) {
+        std::fill(freqs, freqs + HUFF_SYMBOLS, 1);
+        nextRebuild = step;
+        rebuild();
+    }
+
+    const HuffCode* codes() const { return codeTable; }
+    const HuffDecoder& decoder() const { return dec; }
+
+    void update(uint8_t s) {
+        freqs[s]++;
+        total++;
+        if (++seen == nextRebuild) {
+            step = std::min<uint64_t>(step * 2, interval);
+            nextRebuild += step;
+            rebuild();
+        }
+    }
+
+private:
+    void rebuild() {
+        if (total > window) {
+            total = 0;
+            for (int s = 0; s < HUFF_SYMBOLS; s++) {
+                freqs[s] = (freqs[s] + 1) / 2;
+                total += freqs[s];
+            }
+        }
+        huffCodeLengths(freqs, lens, tree);
+        canonicalCodes(lens, codeTable);
+        if (decoding) dec.init(lens);
+    }
+
+    uint32_t interval;
+    uint32_t window;
+    bool decoding;
+    uint64_t step, seen, nextRebuild, total;
+    uint64_t freqs[HUFF_SYMBOLS];
+    uint8_t lens[HUFF_SYMBOLS];
+    HuffCode codeTable[HUFF_SYMBOLS];
+    HuffDecoder dec;
+    HuffTree tree;
+};
+
+// Streaming encoder: encode() may be called with any number of chunks and
+// appends to out in 4-byte words as the bit accumulator fills; finish()
+// writes the remaining bits, padding the last byte.
+class AdaptiveHuffEncoder {
+public:
+    AdaptiveHuffEncoder(uint32_t interval = 4096, uint32_t window = 1 << 16)
+        : model(interval, window, false), writer(nullptr) {}
+
+    void encode(const uint8_t* data, size_t n, std::vector<uint8_t>& out) {
+        size_t used = out.size();
+        out.resize(used + n * HUFF_MAX_LEN / 8 + 8);
+        writer.retarget(out.data() + used);
+        const HuffCode* codes = model.codes();
+        for (size_t i = 0; i < n; i++) {
+            writer.put(codes[data[i]].bits, codes[data[i]].len);
+            model.update(data[i]);
+        }
+        out.resize(writer.position() - out.data());
+    }
+
+    void finish(std::vector<uint8_t>& out) {
+        size_t used = out.size();
+        out.resize(used + 8);
+        writer.retarget(out.data() + used);
+        out.resize(writer.flush() - out.data());
+    }
+
+private:
+    AdaptiveHuffModel model;
+    BitWriter writer;
+};
+
+// Decodes n symbols of an adaptive stream produced with the same parameters.
+bool adaptiveHuffmanUnpack(const uint8_t* src, size_t srcLen, uint8_t* out, size_t n,
+    uint32_t interval = 4096, uint32_t window = 1 << 16) {
+    AdaptiveHuffModel model(interval, window, true);
+    BitReader in(src, srcLen);
+    for (uint8_t* end = out + n; out < end; ) {
+        in.refill();
+        for (int k = 0; k < 3 && out < end; k++) {
+            int s = model.decoder().decode(in);
+            if (s < 0) return false;
+            *out++ = static_cast<uint8_t>(s);
+            model.update(static_cast<uint8_t>(s));
+        }
+    }
+    return in.inBounds();
+}
+
+// One-shot framing: u64 symbol count, u32 interval, u32 window, then the
+// adaptive stream. An interval of 0 is stored as 1, which the decoder accepts.
+std::vector<uint8_t> adaptiveHuffmanEncode(const uint8_t* data, size_t n,
+    uint32_t interval = 4096, uint32_t window = 1 << 16) {
+    interval = std::max<uint32_t>(interval, 1);
+    std::vector<uint8_t> out(16);
+    putLE(out.data(), n, 8);
+    putLE(out.data() + 8, interval, 4);
+    putLE(out.data() + 12, window, 4);
+    AdaptiveHuffEncoder enc(interval, window);
+    enc.encode(data, n, out);
+    enc.finish(out);
+    return out;
+}
+
+bool adaptiveHuffmanDecode(const uint8_t* src, size_t srcLen, std::vector<uint8_t>& out) {
+    if (srcLen < 16) return false;
+    uint64_t n = getLE(src, 8);
+    uint32_t interval = static_cast<uint32_t>(getLE(src + 8, 4));
+    uint32_t window = static_cast<uint32_t>(getLE(src + 12, 4));
+    if (interval == 0 || n > uint64_t(srcLen - 16) * 8) return false;
+    out.resize(n);
+    return adaptiveHuffmanUnpack(src + 16, srcLen - 16, out.data(), n, interval, window);
+}
+
 int main() {
+    // the same tree as BinNodes and as a compact array in both layouts
+    BinTree<int> bt;
+    std::vector<BinNodePosi<int>> made = { bt.insert(0) };
+    for (int i = 1; i < (1 << 20); i++) {
+        BinNodePosi<int> p = made[(i - 1) / 2];
+        made.push_back(i % 2 ? bt.insert(i, p) : bt.insert(p, i));
+    }
+    CompactBinTree<int> bfs(bt, CompactBinTree<int>::BFS), veb(bt, CompactBinTree<int>::VEB);
+    const char* orders[] = { "level", "pre", "in", "post" };
+    for (int o = 0; o < 4; o++) {
+        Digest d[3];
+        double ms[3];
+        for (int k = 0; k < 3; k++) {
+            auto t0 = std::chrono::steady_clock::now();
+            if (k == 0) {
+                if (o == 0) bt.travLevel(d[k]); else if (o == 1) bt.travPre(d[k]);
+                else if (o == 2) bt.travIn(d[k]); else bt.travPost(d[k]);
+            }
+            else {
+                CompactBinTree<int>& c = k == 1 ? bfs : veb;
+                if (o == 0) c.travLevel(d[k]); else if (o == 1) c.travPre(d[k]);
+                else if (o == 2) c.travIn(d[k]); else c.travPost(d[k]);
+            }
+            ms[k] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        }
+        std::cout << "trav" << orders[o] << ": BinNode " << ms[0] << " ms, BFS array " << ms[1]
+            << " ms, vEB array " << ms[2] << " ms"
+            << (d[0].h == d[1].h && d[0].h == d[2].h ? "" : " MISMATCH") << "\n";
+    }
+
+    // a million-deep left spine, which recursive traversals could not walk,
+    // and two visitors fused into one in-order pass
+    BinNodePosi<int> spine = NULL;
+    for (int i = 0; i < 1000000; i++) spine = new BinNode<int>(i, NULL, spine);
+    Digest first, second;
+    auto both = fuse(first, second);
+    spine->travIn(both);
+    Digest post;
+    spine->travPost(post);
+    std::cout << "spine: in-order " << (first.h == second.h ? "fused ok" : "fused MISMATCH")
+        << ", post-order " << (post.h == first.h ? "ok" : "MISMATCH") << "\n";
+    while (spine) {
+        BinNodePosi<int> next = spine->lc;
+        delete spine;
+        spine = next;
+    }
+
+    // ascending keys, the worst case for an unbalanced BST
+    AVL<int> avl;
+    auto a0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000000; i++) avl.insert(i);
+    int found = 0;
+    for (int i = 0; i < 1000000; i += 3) found += avl.search(i) != NULL;
+    for (int i = 0; i < 1000000; i += 2) avl.remove(i);
+    auto a1 = std::chrono::steady_clock::now();
+    std::cout << "AVL: size " << avl.size() << ", height " << avl.root()->height << ", found " << found << " in "
+        << std::chrono::duration<double, std::milli>(a1 - a0).count() << " ms\n";
+    std::cout << "AVL: median " << avl.select(avl.size() / 2)->data << ", rank(777777) " << avl.rank(777777) << "\n";
+
+    // subtree sums answer range queries without visiting the range
+    AVL<Keyed<int, SumMonoid<int>>> sums;
+    for (int i = 0; i < 100000; i++) sums.insert(rand() % 1000000);
+    long long direct = 0;
+    for (Rank k = sums.rank(250000); k < sums.size() && sums.select(k)->data.key < 500000; k++)
+        direct += sums.select(k)->data.key;
+    std::cout << "sum of keys in [250000, 500000): " << rangeAggregate(sums, 250000, 500000)
+        << (rangeAggregate(sums, 250000, 500000) == direct ? " ok" : " MISMATCH") << "\n";
+
+    // merging per-shard priority queues
+    const int shards = 64, perShard = 20000;
+    std::vector<int> keys(shards * perShard);
+    for (int& k : keys) k = rand();
+    {
+        auto pool = std::make_shared<BinNodePool<int>>();
+        std::vector<std::unique_ptr<LeftHeap<int>>> leftShards;
+        std::vector<std::unique_ptr<SkewHeap<int>>> skewShards;
+        for (int s = 0; s < shards; s++) {
+            leftShards.emplace_back(new LeftHeap<int>(pool));
+            skewShards.emplace_back(new SkewHeap<int>(pool));
+        }
+        auto left = [&](int s) -> LeftHeap<int>& { return *leftShards[s]; };
+        auto skew = [&](int s) -> SkewHeap<int>& { return *skewShards[s]; };
+        std::vector<std::priority_queue<int>> stl(shards);
+        for (int i = 0; i < shards * perShard; i++) {
+            left(i % shards).insert(keys[i]);
+            skew(i % shards).insert(keys[i]);
+            stl[i % shards].push(keys[i]);
+        }
+        auto m0 = std::chrono::steady_clock::now();
+        for (int s = 1; s < shards; s++) left(0).merge(left(s));
+        auto m1 = std::chrono::steady_clock::now();
+        for (int s = 1; s < shards; s++) skew(0).merge(skew(s));
+        auto m2 = std::chrono::steady_clock::now();
+        for (int s = 1; s < shards; s++) {
+            for (; !stl[s].empty(); stl[s].pop()) stl[0].push(stl[s].top());
+        }
+        auto m3 = std::chrono::steady_clock::now();
+        bool same = left(0).size() == stl[0].size() && skew(0).size() == stl[0].size();
+        for (; same && !stl[0].empty(); stl[0].pop())
+            same = left(0).delMax() == stl[0].top() && skew(0).delMax() == stl[0].top();
+        std::cout << "merge " << shards << " shards: leftist "
+            << std::chrono::duration<double, std::micro>(m1 - m0).count() << " us, skew "
+            << std::chrono::duration<double, std::micro>(m2 - m1).count() << " us, priority_queue "
+            << std::chrono::duration<double, std::micro>(m3 - m2).count() << " us"
+            << (same ? "" : " MISMATCH") << "\n";
+    }
+
     HuffTree huffTree;
     std::vector<std::pair<char, int>> charFreqs = {
         {'a', 6}, {'b', 9}, {'c', 16}, {'d', 19}, {'e', 26}, {'f', 65}
     };
     huffTree.build(charFreqs);
     huffTree.displayHuffmanCodes();
+
+    // round-trip corpus
+    std::vector<std::vector<uint8_t>> corpus(6);
+    corpus[1] = { 'x' };
+    for (int s = 0; s < 256; s++) corpus[2].push_back(static_cast<uint8_t>(s));
+    for (int i = 0; i < 100000; i++) corpus[3].push_back(static_cast<uint8_t>(rand()));
+    // Fibonacci-like counts force the code lengths to be limited
+    for (int s = 0, a = 1, b = 1; s < 26; s++, b = a + b, a = b - a)
+        corpus[4].insert(corpus[4].end(), a, static_cast<uint8_t>('a' + s));
+    const char* line = "2024-10-19 12:00:00 INFO request served in 12 ms\n";
+    for (int i = 0; i < 2000; i++) corpus[5].insert(corpus[5].end(), line, line + strlen(line));
+    for (size_t c = 0; c < corpus.size(); c++) {
+        std::vector<uint8_t> packed = huffmanEncode(corpus[c].data(), corpus[c].size());
+        std::vector<uint8_t> unpacked;
+        bool ok = huffmanDecode(packed.data(), packed.size(), unpacked) && unpacked == corpus[c];
+        std::cout << "corpus " << c << ": " << corpus[c].size() << " -> " << packed.size()
+            << (ok ? " ok" : " FAILED") << "\n";
+    }
+
+    // throughput on synthetic log text
+    std::vector<uint8_t> logs;
+    const char* words[] = { "INFO ", "WARN ", "GET ", "/api/v1/items ", "200 ", "404 ", "user=", "42 ", "ms\n" };
+    while (logs.size() < (64u << 20)) {
+        const char* w = words[rand() % 9];
+        logs.insert(logs.end(), w, w + strlen(w));
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<uint8_t> packed = huffmanEncode(logs.data(), logs.size());
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<uint8_t> unpacked;
+    bool ok = huffmanDecode(packed.data(), packed.size(), unpacked);
+    auto t2 = std::chrono::steady_clock::now();
+    ok = ok && unpacked == logs;
+    double mb = logs.size() / 1048576.0;
+    std::cout << "encode " << mb / std::chrono::duration<double>(t1 - t0).count() << " MB/s, decode "
+        << mb / std::chrono::duration<double>(t2 - t1).count() << " MB/s, ratio "
+        << double(packed.size()) / logs.size() << (ok ? "" : " FAILED") << "\n";
+
+    // block container, per-block and shared tables
+    for (int shared = 0; shared < 2; shared++) {
+        t0 = std::chrono::steady_clock::now();
+        packed = huffmanEncodeBlocks(logs.data(), logs.size(), 1 << 20, shared != 0);
+        t1 = std::chrono::steady_clock::now();
+        ok = huffmanDecodeBlocks(packed.data(), packed.size(), unpacked);
+        t2 = std::chrono::steady_clock::now();
+        ok = ok && unpacked == logs;
+        std::vector<uint8_t> block;
+        ok = ok && huffmanDecodeBlock(packed.data(), packed.size(), 7, block) &&
+            std::equal(block.begin(), block.end(), logs.begin() + 7 * (1 << 20));
+        std::cout << (shared ? "blocks, shared table: " : "blocks, own tables: ")
+            << mb / std::chrono::duration<double>(t1 - t0).count() << " MB/s encode, "
+            << mb / std::chrono::duration<double>(t2 - t1).count() << " MB/s decode, ratio "
+            << double(packed.size()) / logs.size() << (ok ? "" : " FAILED") << "\n";
+    }
+
+    // adaptive versus static two-pass coding, on the logs and on a stream
+    // whose statistics change halfway
+    std::vector<uint8_t> drift(logs.begin(), logs.begin() + (8 << 20));
+    for (size_t i = drift.size() / 2; i < drift.size(); i++) drift[i] = static_cast<uint8_t>('a' + rand() % 4);
+    std::vector<uint8_t>* inputs[] = { &logs, &drift };
+    for (std::vector<uint8_t>* in : inputs) {
+        double inMb = in->size() / 1048576.0;
+        std::vector<uint8_t> stat = huffmanEncode(in->data(), in->size());
+        t0 = std::chrono::steady_clock::now();
+        packed = adaptiveHuffmanEncode(in->data(), in->size());
+        t1 = std::chrono::steady_clock::now();
+        ok = adaptiveHuffmanDecode(packed.data(), packed.size(), unpacked);
+        t2 = std::chrono::steady_clock::now();
+        ok = ok && unpacked == *in;
+        std::cout << (in == &logs ? "adaptive, logs: " : "adaptive, drifting: ")
+            << inMb / std::chrono::duration<double>(t1 - t0).count() << " MB/s encode, "
+            << inMb / std::chrono::duration<double>(t2 - t1).count() << " MB/s decode, ratio "
+            << double(packed.size()) / in->size() << " vs static " << double(stat.size()) / in->size()
+            << (ok ? "" : " FAILED") << "\n";
+    }
     return 0;
 }
\ No newline at end of file
@@ -4,9 +4,40 @@
 #include <queue>
 #include <stack>
 #include <climits> // For INT_MAX
+#include <cmath>
 #include <utility> // For std::pair
 #include <tuple>   // For std::tuple
 #include <algorithm> // For std::sort
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 // ȼзװ
 template<typename T, typename Compare = std::greater<T>>
@@ -44,6 +75,8 @@ public:
     }
 
     void addEdge(int u, int v, int weight = 1) {
+        minWeight = std::min(minWeight, weight);
+        maxWeight = std::max(maxWeight, weight);
         adjList[u].push_back({ v, weight });
         adjList[v].push_back({ u, weight }); // ͼ
     }
@@ -62,17 +95,476 @@ public:
         return adjList;
     }
 
+    // {neighbor, weight} pairs of v; CSRGraph offers the same interface
+    const std::list<std::pair<int, int>>& neighbors(int v) const {
+        return adjList[v];
+    }
+
     int getVertices() const {
         return vertices;
     }
 
+    // INT_MAX / INT_MIN while there are no edges
+    int getMinWeight() const { return minWeight; }
+    int getMaxWeight() const { return maxWeight; }
+
 private:
     int vertices;
     std::vector<std::list<std::pair<int, int>>> adjList;
+    int minWeight = INT_MAX;
+    int maxWeight = INT_MIN;
+};
+
+// Number of worker threads to use when the caller passes 0
+inline unsigned resolveThreads(unsigned threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+}
+
+// Splits [0, n) into one contiguous block per thread and runs
+// body(begin, end, threadIndex) on each; returns when all blocks are done.
+template <typename F>
+void parallelFor(size_t n, unsigned threads, F body) {
+    threads = resolveThreads(threads);
+    if (threads > n) threads = n == 0 ? 1 : unsigned(n);
+    if (threads == 1) {
+        body(size_t(0), n, 0u);
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t)
+        pool.emplace_back(body, n * t / threads, n * (t + 1) / threads, t);
+    for (auto& th : pool) th.join();
+}
+
+// Index of the lowest set bit; x must be nonzero
+inline int lowestBit(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return int(i);
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+struct WeightedEdge {
+    int u, v, weight;
+};
+
+// ѹϡ (CSR) ͼ: the neighbors of u are adj[offsets[u] .. offsets[u+1])
+// with matching weights, sorted by neighbor id. Immutable once built.
+class CSRGraph {
+public:
+    class NeighborIterator {
+    public:
+        NeighborIterator(const int* v, const int* w) : v(v), w(w) {}
+        std::pair<int, int> operator*() const { return { *v, *w }; }
+        NeighborIterator& operator++() { ++v; ++w; return *this; }
+        bool operator!=(const NeighborIterator& o) const { return v != o.v; }
+        bool operator==(const NeighborIterator& o) const { return v == o.v; }
+    private:
+        const int* v;
+        const int* w;
+    };
+
+    class NeighborRange {
+    public:
+        NeighborRange(const int* v, const int* w, size_t n) : v(v), w(w), n(n) {}
+        NeighborIterator begin() const { return { v, w }; }
+        NeighborIterator end() const { return { v + n, w + n }; }
+        size_t size() const { return n; }
+        const int* vertices() const { return v; }
+        const int* weights() const { return w; }
+    private:
+        const int* v;
+        const int* w;
+        size_t n;
+    };
+
+    CSRGraph() : vertices(0), offsets(1, 0) {}
+
+    // Counting-sort construction; an undirected edge is stored in both
+    // directions. threads = 0 uses every hardware thread.
+    static CSRGraph fromEdges(int vertices, const std::vector<WeightedEdge>& edges,
+        bool undirected = true, unsigned threads = 0);
+    static CSRGraph fromGraph(const Graph& graph, unsigned threads = 0);
+
+    NeighborRange neighbors(int u) const {
+        return { adj.data() + offsets[u], weight.data() + offsets[u], offsets[u + 1] - offsets[u] };
+    }
+    size_t degree(int u) const { return offsets[u + 1] - offsets[u]; }
+    int getVertices() const { return vertices; }
+    size_t getArcs() const { return adj.size(); }
+    size_t memoryBytes() const {
+        return offsets.size() * sizeof(size_t) + adj.size() * sizeof(int) + weight.size() * sizeof(int);
+    }
+
+    const std::vector<size_t>& getOffsets() const { return offsets; }
+    const std::vector<int>& getAdj() const { return adj; }
+    const std::vector<int>& getWeights() const { return weight; }
+    // raw arrays, shared with CSRSnapshot so parallel kernels accept either
+    const size_t* offsetData() const { return offsets.data(); }
+    const int* adjData() const { return adj.data(); }
+    const int* weightData() const { return weight.data(); }
+
+    // INT_MAX / INT_MIN while there are no edges
+    int getMinWeight() const { return minWeight; }
+    int getMaxWeight() const { return maxWeight; }
+
+private:
+    int vertices;
+    std::vector<size_t> offsets;
+    std::vector<int> adj;
+    std::vector<int> weight;
+    int minWeight = INT_MAX;
+    int maxWeight = INT_MIN;
+};
+
+CSRGraph CSRGraph::fromEdges(int vertices, const std::vector<WeightedEdge>& edges,
+    bool undirected, unsigned threads) {
+    threads = resolveThreads(threads);
+    CSRGraph g;
+    g.vertices = vertices;
+    size_t n = size_t(vertices);
+    size_t arcs = edges.size() * (undirected ? 2 : 1);
+    std::unique_ptr<std::atomic<size_t>[]> cursor(new std::atomic<size_t>[n + 1]());
+
+    // 1. out-degrees and the weight range
+    std::vector<int> lo(threads, INT_MAX), hi(threads, INT_MIN);
+    parallelFor(edges.size(), threads, [&](size_t b, size_t e, unsigned t) {
+        for (size_t i = b; i < e; ++i) {
+            cursor[edges[i].u].fetch_add(1, std::memory_order_relaxed);
+            if (undirected) cursor[edges[i].v].fetch_add(1, std::memory_order_relaxed);
+            lo[t] = std::min(lo[t], edges[i].weight);
+            hi[t] = std::max(hi[t], edges[i].weight);
+        }
+    });
+    g.minWeight = *std::min_element(lo.begin(), lo.end());
+    g.maxWeight = *std::max_element(hi.begin(), hi.end());
+
+    // 2. exclusive prefix sum: block totals, then each block scans from its base
+    g.offsets.assign(n + 1, 0);
+    unsigned blocks = unsigned(std::min<size_t>(threads, std::max<size_t>(n, 1)));
+    std::vector<size_t> base(blocks + 1, 0);
+    parallelFor(n, blocks, [&](size_t b, size_t e, unsigned t) {
+        size_t s = 0;
+        for (size_t i = b; i < e; ++i) s += cursor[i].load(std::memory_order_relaxed);
+        base[t + 1] = s;
+    });
+    for (unsigned t = 0; t < blocks; ++t) base[t + 1] += base[t];
+    parallelFor(n, blocks, [&](size_t b, size_t e, unsigned t) {
+        size_t s = base[t];
+        for (size_t i = b; i < e; ++i) {
+            size_t d = cursor[i].load(std::memory_order_relaxed);
+            g.offsets[i] = s;
+            cursor[i].store(s, std::memory_order_relaxed);
+            s += d;
+        }
+    });
+    g.offsets[n] = arcs;
+
+    // 3. scatter
+    g.adj.resize(arcs);
+    g.weight.resize(arcs);
+    parallelFor(edges.size(), threads, [&](size_t b, size_t e, unsigned) {
+        for (size_t i = b; i < e; ++i) {
+            const WeightedEdge& x = edges[i];
+            size_t p = cursor[x.u].fetch_add(1, std::memory_order_relaxed);
+            g.adj[p] = x.v;
+            g.weight[p] = x.weight;
+            if (undirected) {
+                p = cursor[x.v].fetch_add(1, std::memory_order_relaxed);
+                g.adj[p] = x.u;
+                g.weight[p] = x.weight;
+            }
+        }
+    });
+
+    // 4. the scatter order depends on scheduling; sort each row so the layout is deterministic
+    parallelFor(n, threads, [&](size_t b, size_t e, unsigned) {
+        std::vector<std::pair<int, int>> row;
+        for (size_t u = b; u < e; ++u) {
+            size_t lo = g.offsets[u], hi = g.offsets[u + 1];
+            row.clear();
+            for (size_t p = lo; p < hi; ++p) row.push_back({ g.adj[p], g.weight[p] });
+            std::sort(row.begin(), row.end());
+            for (size_t p = lo; p < hi; ++p) {
+                g.adj[p] = row[p - lo].first;
+                g.weight[p] = row[p - lo].second;
+            }
+        }
+    });
+    return g;
+}
+
+CSRGraph CSRGraph::fromGraph(const Graph& graph, unsigned threads) {
+    std::vector<WeightedEdge> edges;
+    for (int u = 0; u < graph.getVertices(); ++u) {
+        for (auto& edge : graph.neighbors(u)) {
+            edges.push_back({ u, edge.first, edge.second });
+        }
+    }
+    return fromEdges(graph.getVertices(), edges, false, threads);
+}
+
+// R-MAT generator (Chakrabarti et al.): 2^scale vertices and
+// edgeFactor * 2^scale edges with skewed, power-law-like degrees
+std::vector<WeightedEdge> rmatEdges(int scale, int edgeFactor, int maxWeight, unsigned seed = 1,
+    double a = 0.57, double b = 0.19, double c = 0.19) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::vector<WeightedEdge> edges(size_t(edgeFactor) << scale);
+    for (auto& e : edges) {
+        int u = 0, v = 0;
+        for (int bit = 0; bit < scale; ++bit) {
+            double r = coin(rng);
+            if (r >= a + b + c) { u |= 1 << bit; v |= 1 << bit; }
+            else if (r >= a + b) u |= 1 << bit;
+            else if (r >= a) v |= 1 << bit;
+        }
+        e = { u, v, 1 + int(rng() % unsigned(maxWeight)) };
+    }
+    return edges;
+}
+
+// side x side grid with 4-neighbor edges, vertex y * side + x
+std::vector<WeightedEdge> gridEdges(int side, int maxWeight, unsigned seed = 1) {
+    std::mt19937 rng(seed);
+    std::vector<WeightedEdge> edges;
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            int v = y * side + x;
+            if (x + 1 < side) edges.push_back({ v, v + 1, 1 + int(rng() % unsigned(maxWeight)) });
+            if (y + 1 < side) edges.push_back({ v, v + side, 1 + int(rng() % unsigned(maxWeight)) });
+        }
+    }
+    return edges;
+}
+
+// Read-only memory map of a whole file; an empty file maps to no bytes
+class MappedFile {
+public:
+    explicit MappedFile(const char* path) : ptr(nullptr), len(0), ok(false) {
+#ifdef _WIN32
+        mapping = NULL;
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) return;
+        len = size_t(size.QuadPart);
+        if (len > 0) {
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (!mapping) return;
+            ptr = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            if (!ptr) return;
+        }
+#else
+        fd = open(path, O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) != 0) return;
+        len = size_t(st.st_size);
+        if (len > 0) {
+            void* p = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) return;
+            ptr = static_cast<const char*>(p);
+        }
+#endif
+        ok = true;
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (ptr) UnmapViewOfFile(ptr);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (ptr) munmap(const_cast<char*>(ptr), len);
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool valid() const { return ok; }
+    const char* data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+#ifdef _WIN32
+    HANDLE file, mapping;
+#else
+    int fd;
+#endif
+    const char* ptr;
+    size_t len;
+    bool ok;
+};
+
+// ߱: one edge per line, "u v" or "u v weight" (weight defaults to 1),
+// separated by spaces or tabs; blank lines and lines starting with '#' or
+// '%' are skipped. The text is cut into one chunk per thread at line
+// boundaries, each chunk is parsed with from_chars into its own vector,
+// and the vectors are joined in file order. vertices becomes the largest
+// id + 1, so ids must lie in [0, INT_MAX). Returns false if any line is
+// malformed or has an id out of range.
+bool parseEdgeList(const char* text, size_t size, int& vertices, std::vector<WeightedEdge>& edges,
+    unsigned threads = 0) {
+    threads = resolveThreads(threads);
+    if (size < (size_t(1) << 16)) threads = 1;
+    std::vector<size_t> cut(threads + 1, size);
+    cut[0] = 0;
+    for (unsigned t = 1; t < threads; ++t) {
+        size_t p = std::max(cut[t - 1], size * t / threads);
+        while (p < size && p > 0 && text[p - 1] != '\n') ++p;
+        cut[t] = p;
+    }
+
+    std::vector<std::vector<WeightedEdge>> parts(threads);
+    std::vector<int> maxId(threads, -1);
+    std::vector<char> bad(threads, 0);
+    parallelFor(threads, threads, [&](size_t, size_t, unsigned t) {
+        const char* p = text + cut[t];
+        const char* end = text + cut[t + 1];
+        auto blank = [&] { while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p; };
+        while (p < end) {
+            blank();
+            if (p < end && *p != '\n' && *p != '#' && *p != '%') {
+                WeightedEdge e = { 0, 0, 1 };
+                auto r = std::from_chars(p, end, e.u);
+                bool good = r.ec == std::errc() && e.u >= 0 && e.u < INT_MAX;
+                p = r.ptr;
+                blank();
+                r = std::from_chars(p, end, e.v);
+                good = good && r.ec == std::errc() && e.v >= 0 && e.v < INT_MAX;
+                p = r.ptr;
+                blank();
+                if (p < end && *p != '\n') {
+                    r = std::from_chars(p, end, e.weight);
+                    good = good && r.ec == std::errc();
+                    p = r.ptr;
+                    blank();
+                }
+                if (good && (p == end || *p == '\n')) {
+                    parts[t].push_back(e);
+                    maxId[t] = std::max(maxId[t], std::max(e.u, e.v));
+                }
+                else bad[t] = 1;
+            }
+            while (p < end && *p != '\n') ++p;
+            if (p < end) ++p;
+        }
+    });
+
+    size_t total = 0;
+    for (auto& part : parts) total += part.size();
+    edges.clear();
+    edges.reserve(total);
+    for (auto& part : parts) edges.insert(edges.end(), part.begin(), part.end());
+    vertices = *std::max_element(maxId.begin(), maxId.end()) + 1;
+    return std::find(bad.begin(), bad.end(), 1) == bad.end();
+}
+
+bool loadEdgeList(const char* path, int& vertices, std::vector<WeightedEdge>& edges, unsigned threads = 0) {
+    MappedFile file(path);
+    return file.valid() && parseEdgeList(file.data(), file.size(), vertices, edges, threads);
+}
+
+// Binary CSR snapshot: this header, then (vertices + 1) u64 offsets,
+// arcs i32 neighbors and arcs i32 weights, all in native byte order.
+// Every array starts 8-byte aligned, so a mapped file is used in place.
+struct SnapshotHeader {
+    char magic[8];       // "DSCSR01"
+    uint32_t byteOrder;  // 0x01020304 as written
+    int32_t minWeight, maxWeight;
+    uint32_t reserved;
+    uint64_t vertices, arcs;
+};
+const char SNAPSHOT_MAGIC[8] = "DSCSR01";
+
+bool saveSnapshot(const CSRGraph& graph, const char* path) {
+    SnapshotHeader h;
+    std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof h.magic);
+    h.byteOrder = 0x01020304;
+    h.minWeight = graph.getMinWeight();
+    h.maxWeight = graph.getMaxWeight();
+    h.reserved = 0;
+    h.vertices = uint64_t(graph.getVertices());
+    h.arcs = graph.getArcs();
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    std::vector<uint64_t> chunk;
+    for (size_t i = 0; i <= size_t(h.vertices); i += 1 << 16) {
+        size_t e = std::min(size_t(h.vertices) + 1, i + (1 << 16));
+        chunk.assign(graph.offsetData() + i, graph.offsetData() + e);
+        out.write(reinterpret_cast<const char*>(chunk.data()), std::streamsize(chunk.size() * sizeof(uint64_t)));
+    }
+    out.write(reinterpret_cast<const char*>(graph.adjData()), std::streamsize(h.arcs * sizeof(int)));
+    out.write(reinterpret_cast<const char*>(graph.weightData()), std::streamsize(h.arcs * sizeof(int)));
+    return static_cast<bool>(out);
+}
+
+// A CSR graph read in place from a mapped snapshot: opening costs one
+// mmap plus a header check, whatever the graph size, and pages are loaded
+// as they are touched. Offers the same interface as CSRGraph.
+// By default valid() only vouches for the header, the file size and the
+// first and last offsets; the kernels trust the rest, so a damaged file can
+// still send them out of bounds. With verify = true the constructor also
+// makes one O(V + E) pass checking that offsets never decrease and that
+// every neighbor id lies in [0, V), reading the whole file.
+class CSRSnapshot {
+public:
+    explicit CSRSnapshot(const char* path, bool verify = false)
+        : file(path), header(nullptr), off(nullptr), adj(nullptr), weight(nullptr) {
+        if (!file.valid() || file.size() < sizeof(SnapshotHeader)) return;
+        const SnapshotHeader* h = reinterpret_cast<const SnapshotHeader*>(file.data());
+        if (std::memcmp(h->magic, SNAPSHOT_MAGIC, sizeof h->magic) != 0 || h->byteOrder != 0x01020304) return;
+        if (h->vertices >= uint64_t(INT_MAX) || h->arcs > (uint64_t(-1) >> 4)) return;
+        uint64_t need = sizeof(SnapshotHeader) + (h->vertices + 1) * sizeof(uint64_t) + h->arcs * 2 * sizeof(int);
+        if (file.size() != need) return;
+        off = reinterpret_cast<const uint64_t*>(file.data() + sizeof(SnapshotHeader));
+        if (off[0] != 0 || off[h->vertices] != h->arcs) return;
+        adj = reinterpret_cast<const int*>(off + h->vertices + 1);
+        weight = adj + h->arcs;
+        if (verify) {
+            for (uint64_t u = 0; u < h->vertices; ++u)
+                if (off[u] > off[u + 1]) return;
+            for (uint64_t i = 0; i < h->arcs; ++i)
+                if (adj[i] < 0 || uint64_t(adj[i]) >= h->vertices) return;
+        }
+        header = h;
+    }
+
+    bool valid() const { return header != nullptr; }
+
+    CSRGraph::NeighborRange neighbors(int u) const {
+        return { adj + off[u], weight + off[u], size_t(off[u + 1] - off[u]) };
+    }
+    size_t degree(int u) const { return size_t(off[u + 1] - off[u]); }
+    int getVertices() const { return int(header->vertices); }
+    size_t getArcs() const { return size_t(header->arcs); }
+    int getMinWeight() const { return header->minWeight; }
+    int getMaxWeight() const { return header->maxWeight; }
+
+    const uint64_t* offsetData() const { return off; }
+    const int* adjData() const { return adj; }
+    const int* weightData() const { return weight; }
+
+private:
+    MappedFile file;
+    const SnapshotHeader* header;
+    const uint64_t* off;
+    const int* adj;
+    const int* weight;
 };
 
 // BFS 㷨
-void BFS(const Graph& graph, int start) {
+template <typename G>
+void BFS(const G& graph, int start) {
     int vertices = graph.getVertices();
     std::vector<bool> visited(vertices, false);
     std::queue<int> q;
@@ -86,7 +578,7 @@ void BFS(const Graph& graph, int start) {
         q.pop();
         std::cout << v << " ";
 
-        for (auto& edge : graph.getAdjList()[v]) {
+        for (auto edge : graph.neighbors(v)) {
             int neighbor = edge.first;
             if (!visited[neighbor]) {
                 visited[neighbor] = true;
@@ -97,71 +589,1046 @@ void BFS(const Graph& graph, int start) {
     std::cout << std::endl;
 }
 
+struct BFSResult {
+    std::vector<int> dist;    // , -1 if unreachable
+    std::vector<int> parent;  // -1 for the source and unreachable vertices
+};
+
+// Direction-optimizing BFS (Beamer, Asanovic, Patterson). Top-down steps
+// expand a vertex queue and claim vertices with an atomic fetch_or on the
+// visited bitmap; once the frontier's edges outnumber the unexplored edges
+// by 1/alpha, bottom-up steps let every unvisited vertex look for a parent
+// in the frontier bitmap instead. It switches back when the frontier falls
+// below n/beta and is shrinking. Bottom-up reads neighbors as in-neighbors,
+// so the graph must be symmetric (built with undirected = true).
+template <typename CSR>
+BFSResult parallelBFS(const CSR& graph, int source, unsigned threads = 0,
+    int alpha = 14, int beta = 24) {
+    threads = resolveThreads(threads);
+    const size_t n = size_t(graph.getVertices());
+    const size_t words = (n + 63) / 64;
+    auto off = graph.offsetData();
+    const int* adj = graph.adjData();
+
+    BFSResult r;
+    r.dist.assign(n, -1);
+    r.parent.assign(n, -1);
+    std::unique_ptr<std::atomic<uint64_t>[]> visited(new std::atomic<uint64_t>[words]());
+    std::vector<uint64_t> front(words), next(words);
+    std::vector<int> queue(1, source);
+    std::vector<std::vector<int>> local(threads);
+    std::vector<long long> localEdges(threads), localCount(threads);
+
+    visited[source >> 6].store(uint64_t(1) << (source & 63), std::memory_order_relaxed);
+    r.dist[source] = 0;
+    long long scout = (long long)graph.degree(source);          // edges out of the frontier
+    long long unexplored = (long long)graph.getArcs() - scout;  // edges out of unvisited vertices
+    size_t frontier = 1, previous = 0;
+    bool bottomUp = false;
+
+    for (int level = 1; frontier > 0; ++level) {
+        if (!bottomUp && scout > unexplored / alpha) {
+            std::fill(front.begin(), front.end(), 0);
+            for (int v : queue) front[v >> 6] |= uint64_t(1) << (v & 63);
+            bottomUp = true;
+        }
+        else if (bottomUp && frontier < n / beta && frontier < previous) {
+            queue.clear();
+            for (size_t w = 0; w < words; ++w)
+                for (uint64_t bits = front[w]; bits; bits &= bits - 1)
+                    queue.push_back(int(w * 64 + lowestBit(bits)));
+            bottomUp = false;
+        }
+        previous = frontier;
+
+        // parallelFor runs fewer threads than asked when there is less
+        // work, so slots it did not use must not keep the last level's values
+        for (unsigned t = 0; t < threads; ++t) {
+            local[t].clear();
+            localEdges[t] = 0;
+            localCount[t] = 0;
+        }
+        if (bottomUp) {
+            parallelFor(words, threads, [&](size_t b, size_t e, unsigned t) {
+                long long edges = 0, count = 0;
+                for (size_t w = b; w < e; ++w) {
+                    uint64_t seen = visited[w].load(std::memory_order_relaxed), found = 0;
+                    uint64_t todo = ~seen;
+                    if (w == words - 1 && n % 64) todo &= (uint64_t(1) << (n % 64)) - 1;
+                    for (; todo; todo &= todo - 1) {
+                        int bit = lowestBit(todo);
+                        size_t v = w * 64 + bit;
+                        for (size_t p = off[v]; p < off[v + 1]; ++p) {
+                            int u = adj[p];
+                            if (front[u >> 6] >> (u & 63) & 1) {
+                                r.parent[v] = u;
+                                r.dist[v] = level;
+                                found |= uint64_t(1) << bit;
+                                edges += (long long)(off[v + 1] - off[v]);
+                                ++count;
+                                break;
+                            }
+                        }
+                    }
+                    next[w] = found;
+                    visited[w].store(seen | found, std::memory_order_relaxed);
+                }
+                localEdges[t] = edges;
+                localCount[t] = count;
+            });
+            front.swap(next);
+        }
+        else {
+            parallelFor(queue.size(), scout < 4096 ? 1 : threads, [&](size_t b, size_t e, unsigned t) {
+                std::vector<int>& out = local[t];
+                long long edges = 0;
+                for (size_t i = b; i < e; ++i) {
+                    int u = queue[i];
+                    for (size_t p = off[u]; p < off[u + 1]; ++p) {
+                        int v = adj[p];
+                        uint64_t bit = uint64_t(1) << (v & 63);
+                        if (visited[v >> 6].load(std::memory_order_relaxed) & bit) continue;
+                        if (visited[v >> 6].fetch_or(bit, std::memory_order_relaxed) & bit) continue;
+                        r.parent[v] = u;
+                        r.dist[v] = level;
+                        out.push_back(v);
+                        edges += (long long)(off[v + 1] - off[v]);
+                    }
+                }
+                localEdges[t] = edges;
+                localCount[t] = (long long)out.size();
+            });
+            queue.clear();
+            for (unsigned t = 0; t < threads; ++t) queue.insert(queue.end(), local[t].begin(), local[t].end());
+        }
+
+        scout = 0;
+        frontier = 0;
+        for (unsigned t = 0; t < threads; ++t) {
+            scout += localEdges[t];
+            frontier += size_t(localCount[t]);
+        }
+        unexplored -= scout;
+    }
+    return r;
+}
+
 // DFS 㷨
-void DFSUtil(const Graph& graph, int v, std::vector<bool>& visited) {
-    visited[v] = true;
-    std::cout << v << " ";
+enum class EdgeType { Tree, Back, Forward, Cross };
+
+// No-op hooks for DFSEngine; visitors override the ones they need
+struct DFSVisitor {
+    void root(int) {}
+    void discover(int) {}
+    void edge(int, int, EdgeType) {}
+    void finish(int) {}
+};
+
+// Iterative depth-first search over any graph with neighbors(v). Each
+// stack frame keeps its own neighbor iterator, so vertices are visited in
+// the same order as the recursive version without using the call stack.
+// Discovery and finish times share one clock (CLRS). In undirected mode the
+// edge back to the parent is skipped once and edges to finished vertices
+// are dropped, so every undirected edge is reported once, as Tree or Back.
+template <typename G>
+class DFSEngine {
+public:
+    explicit DFSEngine(const G& graph, bool undirected = true)
+        : graph(graph), undirected(undirected) {
+        reset();
+    }
+
+    void reset() {
+        size_t n = size_t(graph.getVertices());
+        disc.assign(n, -1);
+        fin.assign(n, -1);
+        par.assign(n, -1);
+        clock = 0;
+    }
+
+    // Explores the tree rooted at root, if root is still undiscovered
+    template <typename Visitor>
+    void run(int root, Visitor& vis);
+
+    // Explores every vertex, starting new trees in vertex order
+    template <typename Visitor>
+    void runAll(Visitor& vis) {
+        for (int v = 0; v < graph.getVertices(); ++v) run(v, vis);
+    }
+
+    const std::vector<int>& discovery() const { return disc; }
+    const std::vector<int>& finish() const { return fin; }
+    const std::vector<int>& parent() const { return par; }
+
+private:
+    using Iterator = decltype(std::declval<const G&>().neighbors(0).begin());
+    struct Frame {
+        int v;
+        Iterator it, end;
+        bool skippedParent;
+    };
+
+    template <typename Visitor>
+    void enter(int v, int p, Visitor& vis) {
+        disc[v] = clock++;
+        par[v] = p;
+        vis.discover(v);
+        auto&& range = graph.neighbors(v);
+        stack.push_back({ v, range.begin(), range.end(), false });
+    }
 
-    for (auto& edge : graph.getAdjList()[v]) {
-        int neighbor = edge.first;
-        if (!visited[neighbor]) {
-            DFSUtil(graph, neighbor, visited);
+    const G& graph;
+    bool undirected;
+    std::vector<int> disc, fin, par;
+    int clock;
+    std::vector<Frame> stack;  // reused across runs
+};
+
+template <typename G>
+template <typename Visitor>
+void DFSEngine<G>::run(int root, Visitor& vis) {
+    if (disc[root] >= 0) return;
+    vis.root(root);
+    enter(root, -1, vis);
+    while (!stack.empty()) {
+        Frame& f = stack.back();
+        if (f.it == f.end) {
+            int v = f.v;
+            fin[v] = clock++;
+            stack.pop_back();
+            vis.finish(v);
+            continue;
+        }
+        int u = f.v, v = (*f.it).first;
+        ++f.it;
+        if (undirected && v == par[u] && !f.skippedParent) {
+            f.skippedParent = true;
+        }
+        else if (disc[v] < 0) {
+            vis.edge(u, v, EdgeType::Tree);
+            enter(v, u, vis);  // invalidates f
+        }
+        else if (fin[v] < 0) {
+            vis.edge(u, v, EdgeType::Back);
+        }
+        else if (!undirected) {
+            vis.edge(u, v, disc[u] < disc[v] ? EdgeType::Forward : EdgeType::Cross);
         }
     }
 }
 
-void DFS(const Graph& graph, int start) {
-    int vertices = graph.getVertices();
-    std::vector<bool> visited(vertices, false);
+template <typename G>
+void DFS(const G& graph, int start) {
+    struct Printer : DFSVisitor {
+        void discover(int v) { std::cout << v << " "; }
+    } printer;
+    DFSEngine<G> dfs(graph);
 
     std::cout << "DFS: ";
-    DFSUtil(graph, start, visited);
+    dfs.run(start, printer);
     std::cout << std::endl;
 }
 
-// Dijkstra 㷨
-void dijkstra(const Graph& graph, int start) {
-    int vertices = graph.getVertices();
-    std::vector<int> dist(vertices, INT_MAX);
-    dist[start] = 0;
+// ͨ: component id of every vertex of an undirected graph, numbered
+// in order of their smallest vertex
+template <typename G>
+std::vector<int> connectedComponents(const G& graph, int* count = nullptr) {
+    struct Labeler : DFSVisitor {
+        std::vector<int> label;
+        int components = 0;
+        void root(int) { ++components; }
+        void discover(int v) { label[v] = components - 1; }
+    } labeler;
+    labeler.label.assign(size_t(graph.getVertices()), -1);
+    DFSEngine<G> dfs(graph);
+    dfs.runAll(labeler);
+    if (count) *count = labeler.components;
+    return std::move(labeler.label);
+}
 
-    using PII = std::pair<int, int>; // {distance, vertex}
-    PriorityQueue<PII, std::greater<PII>> pq;
-    pq.push({ 0, start });
+struct CutStructure {
+    std::vector<int> articulationPoints;        // ascending
+    std::vector<std::pair<int, int>> bridges;   // {parent, child} in the DFS tree
+};
 
-    while (!pq.empty()) {
-        int d = pq.top().first;
-        int u = pq.top().second;
-        pq.pop();
+// ؽڵ (Tarjan): low[v] is the earliest discovery time reachable
+// from v's subtree through one back edge. A tree edge p-v is a bridge if
+// low[v] > disc[p], and a non-root p is an articulation point if some
+// child has low[v] >= disc[p]; a root needs two children. Parallel edges
+// show up as back edges, so they correctly rule out a bridge.
+template <typename G>
+CutStructure cutStructure(const G& graph) {
+    struct Tarjan : DFSVisitor {
+        const DFSEngine<G>* dfs;
+        std::vector<int> low, children;
+        std::vector<char> cut;
+        CutStructure out;
+        void discover(int v) { low[v] = dfs->discovery()[v]; }
+        void edge(int u, int v, EdgeType type) {
+            if (type == EdgeType::Back) low[u] = std::min(low[u], dfs->discovery()[v]);
+        }
+        void finish(int v) {
+            int p = dfs->parent()[v];
+            if (p < 0) {
+                if (children[v] >= 2) cut[v] = 1;
+                return;
+            }
+            ++children[p];
+            low[p] = std::min(low[p], low[v]);
+            if (low[v] > dfs->discovery()[p]) out.bridges.push_back({ p, v });
+            if (low[v] >= dfs->discovery()[p] && dfs->parent()[p] >= 0) cut[p] = 1;
+        }
+    } tarjan;
+    size_t n = size_t(graph.getVertices());
+    DFSEngine<G> dfs(graph);
+    tarjan.dfs = &dfs;
+    tarjan.low.assign(n, 0);
+    tarjan.children.assign(n, 0);
+    tarjan.cut.assign(n, 0);
+    dfs.runAll(tarjan);
+    for (size_t v = 0; v < n; ++v)
+        if (tarjan.cut[v]) tarjan.out.articulationPoints.push_back(int(v));
+    return std::move(tarjan.out);
+}
 
-        if (d > dist[u]) continue;
+//  of a directed graph (e.g. a CSRGraph built with undirected = false):
+// vertices by decreasing finish time. Returns false, leaving order
+// incomplete, if a back edge shows the graph has a cycle.
+template <typename G>
+bool topologicalOrder(const G& graph, std::vector<int>& order) {
+    struct Collector : DFSVisitor {
+        std::vector<int>* order;
+        bool cyclic = false;
+        void edge(int, int, EdgeType type) { if (type == EdgeType::Back) cyclic = true; }
+        void finish(int v) { order->push_back(v); }
+    } collector;
+    order.clear();
+    collector.order = &order;
+    DFSEngine<G> dfs(graph, false);
+    dfs.runAll(collector);
+    std::reverse(order.begin(), order.end());
+    return !collector.cyclic;
+}
 
-        for (auto& edge : graph.getAdjList()[u]) {
-            int v = edge.first, weight = edge.second;
-            if (dist[u] + weight < dist[v]) {
-                dist[v] = dist[u] + weight;
-                pq.push({ dist[v], v });
+//  D : a min-heap of (key, vertex) with a position index per
+// vertex, so push() of a queued vertex is a decrease-key and the heap never
+// holds more than one entry per vertex. D = 4 keeps the tree shallow and a
+// node's children in one cache line.
+template <typename Key, int D = 4>
+class IndexedHeap {
+public:
+    explicit IndexedHeap(size_t n = 0) : pos(n, -1) {}
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    bool contains(int v) const { return pos[v] >= 0; }
+
+    // Inserts v, or lowers its key; a larger key is ignored
+    void push(int v, Key key) {
+        if (pos[v] < 0) {
+            pos[v] = int(heap.size());
+            heap.push_back({ key, v });
+        }
+        else if (key < heap[pos[v]].first) {
+            heap[pos[v]].first = key;
+        }
+        else return;
+        siftUp(size_t(pos[v]));
+    }
+
+    Key topKey() const { return heap[0].first; }
+
+    int pop() {
+        int v = heap[0].second;
+        pos[v] = -1;
+        std::pair<Key, int> last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            siftDown(0);
+        }
+        return v;
+    }
+
+    // O(size), not O(n)
+    void clear() {
+        for (auto& e : heap) pos[e.second] = -1;
+        heap.clear();
+    }
+
+private:
+    void siftUp(size_t i) {
+        std::pair<Key, int> x = heap[i];
+        while (i > 0) {
+            size_t p = (i - 1) / D;
+            if (!(x.first < heap[p].first)) break;
+            heap[i] = heap[p];
+            pos[heap[i].second] = int(i);
+            i = p;
+        }
+        heap[i] = x;
+        pos[x.second] = int(i);
+    }
+
+    void siftDown(size_t i) {
+        std::pair<Key, int> x = heap[i];
+        size_t n = heap.size();
+        for (;;) {
+            size_t c = i * D + 1;
+            if (c >= n) break;
+            size_t best = c, end = std::min(c + D, n);
+            for (size_t k = c + 1; k < end; ++k)
+                if (heap[k].first < heap[best].first) best = k;
+            if (!(heap[best].first < x.first)) break;
+            heap[i] = heap[best];
+            pos[heap[i].second] = int(i);
+            i = best;
+        }
+        heap[i] = x;
+        pos[x.second] = int(i);
+    }
+
+    std::vector<std::pair<Key, int>> heap;
+    std::vector<int> pos;
+};
+
+// Dial Ͱ for integer keys that grow monotonically, as in Dijkstra with
+// weights in [0, C]: every queued key lies in [current, current + C], so
+// C + 1 circular buckets suffice. Buckets are intrusive doubly-linked
+// lists, so decrease-key is an O(1) unlink and relink.
+class BucketQueue {
+public:
+    BucketQueue(size_t n, int maxWeight)
+        : head(size_t(maxWeight) + 1, -1), next(n), prev(n), key(n, -1), count(0), current(0) {}
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    bool contains(int v) const { return key[v] >= 0; }
+
+    // Inserts v, or lowers its key; a larger key is ignored
+    void push(int v, long long k) {
+        if (key[v] >= 0) {
+            if (k >= key[v]) return;
+            unlink(v);
+        }
+        else ++count;
+        key[v] = k;
+        int& h = head[size_t(k % (long long)head.size())];
+        prev[v] = -1;
+        next[v] = h;
+        if (h >= 0) prev[h] = v;
+        h = v;
+    }
+
+    long long topKey() {
+        while (head[size_t(current % (long long)head.size())] < 0) ++current;
+        return current;
+    }
+
+    int pop() {
+        topKey();
+        int v = head[size_t(current % (long long)head.size())];
+        unlink(v);
+        key[v] = -1;
+        --count;
+        return v;
+    }
+
+    void clear() {
+        for (int& h : head) {
+            for (int v = h; v >= 0; v = next[v]) key[v] = -1;
+            h = -1;
+        }
+        count = 0;
+        current = 0;
+    }
+
+private:
+    void unlink(int v) {
+        if (prev[v] >= 0) next[prev[v]] = next[v];
+        else head[size_t(key[v] % (long long)head.size())] = next[v];
+        if (next[v] >= 0) prev[next[v]] = prev[v];
+    }
+
+    std::vector<int> head;
+    std::vector<int> next, prev;
+    std::vector<long long> key;  // -1 when not queued
+    size_t count;
+    long long current;
+};
+
+const long long INF_DIST = LLONG_MAX;
+
+struct ShortestPaths {
+    std::vector<long long> dist;  // INF_DIST if unreachable
+    std::vector<int> pred;        // -1 for the source and unreachable vertices
+};
+
+enum class QueueKind { Auto, Heap, Buckets };
+
+// Auto uses buckets for nonnegative weights up to this bound
+const int DIAL_MAX_WEIGHT = 256;
+
+// dist must arrive filled with INF_DIST; pred may be null. Leaves q empty
+// so the caller can reuse it for the next source.
+template <typename G, typename Queue>
+void dijkstraWith(const G& graph, int source, int target, Queue& q, long long* dist, int* pred) {
+    dist[source] = 0;
+    q.push(source, 0);
+    while (!q.empty()) {
+        int u = q.pop();
+        if (u == target) break;
+        long long du = dist[u];
+        for (auto edge : graph.neighbors(u)) {
+            int v = edge.first;
+            long long nd = du + edge.second;
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                if (pred) pred[v] = u;
+                q.push(v, nd);
             }
         }
     }
+    q.clear();
+}
+
+// Single-source shortest paths with nonnegative weights. With target >= 0
+// the search stops once target is settled; dist[target] and its pred chain
+// are then exact, other entries may be tentative.
+template <typename G>
+ShortestPaths shortestPaths(const G& graph, int source, int target = -1, QueueKind kind = QueueKind::Auto) {
+    size_t n = size_t(graph.getVertices());
+    ShortestPaths r;
+    r.dist.assign(n, INF_DIST);
+    r.pred.assign(n, -1);
+    int maxWeight = std::max(graph.getMaxWeight(), 0);
+    if (kind == QueueKind::Auto)
+        kind = graph.getMinWeight() >= 0 && maxWeight <= DIAL_MAX_WEIGHT ? QueueKind::Buckets : QueueKind::Heap;
+    if (kind == QueueKind::Buckets) {
+        BucketQueue q(n, maxWeight);
+        dijkstraWith(graph, source, target, q, r.dist.data(), r.pred.data());
+    }
+    else {
+        IndexedHeap<long long> q(n);
+        dijkstraWith(graph, source, target, q, r.dist.data(), r.pred.data());
+    }
+    return r;
+}
+
+// Vertices from the source to target, empty if target is unreachable
+inline std::vector<int> extractPath(const ShortestPaths& paths, int target) {
+    std::vector<int> path;
+    if (paths.dist[target] == INF_DIST) return path;
+    for (int v = target; v >= 0; v = paths.pred[v]) path.push_back(v);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+// Dijkstra 㷨
+template <typename G>
+void dijkstra(const G& graph, int start) {
+    ShortestPaths sp = shortestPaths(graph, start);
 
     std::cout << "Shortest distances from vertex " << start << ": ";
-    for (int i = 0; i < vertices; ++i) {
-        std::cout << (dist[i] == INT_MAX ? -1 : dist[i]) << " ";
+    for (int i = 0; i < graph.getVertices(); ++i) {
+        std::cout << (sp.dist[i] == INF_DIST ? -1 : sp.dist[i]) << " ";
     }
     std::cout << std::endl;
 }
 
+// A* heuristics: target(t) fixes the destination of the next query and
+// operator()(v) must never exceed the true distance from v to it.
+struct ZeroHeuristic {
+    void target(int) {}
+    long long operator()(int) const { return 0; }
+};
+
+// Straight-line distance times scale, admissible when no edge is cheaper
+// than scale per unit of distance between its endpoints
+class CoordinateHeuristic {
+public:
+    CoordinateHeuristic(const std::vector<std::pair<double, double>>& coords, double scale)
+        : coords(coords), scale(scale), tx(0), ty(0) {}
+    void target(int t) {
+        tx = coords[t].first;
+        ty = coords[t].second;
+    }
+    long long operator()(int v) const {
+        double dx = coords[v].first - tx, dy = coords[v].second - ty;
+        return (long long)(std::sqrt(dx * dx + dy * dy) * scale);
+    }
+
+private:
+    const std::vector<std::pair<double, double>>& coords;
+    double scale;
+    double tx, ty;
+};
+
+// ALT (A*, landmarks, triangle inequality): with exact distances from a few
+// landmarks L, |d(L, t) - d(L, v)| is a lower bound on d(v, t) in an
+// undirected graph. Landmarks are picked farthest-first, each one the vertex
+// farthest from those already chosen. Distances are stored vertex-major so
+// one heuristic call reads a single row.
+template <typename G>
+class ALTHeuristic {
+public:
+    ALTHeuristic(const G& graph, int landmarks, int first = 0)
+        : k(size_t(landmarks)), dist(size_t(graph.getVertices()) * k), row(nullptr) {
+        size_t n = size_t(graph.getVertices());
+        std::vector<long long> nearest(n, INF_DIST);
+        int l = first;
+        for (size_t i = 0; i < k; ++i) {
+            ShortestPaths sp = shortestPaths(graph, l);
+            for (size_t v = 0; v < n; ++v) {
+                dist[v * k + i] = sp.dist[v];
+                nearest[v] = std::min(nearest[v], sp.dist[v]);
+            }
+            chosen.push_back(l);
+            // next landmark: reachable vertex farthest from all chosen ones
+            long long best = -1;
+            for (size_t v = 0; v < n; ++v) {
+                if (nearest[v] != INF_DIST && nearest[v] > best) {
+                    best = nearest[v];
+                    l = int(v);
+                }
+            }
+        }
+    }
+
+    void target(int t) { row = &dist[size_t(t) * k]; }
+    long long operator()(int v) const {
+        const long long* d = &dist[size_t(v) * k];
+        long long h = 0;
+        for (size_t i = 0; i < k; ++i) {
+            if (d[i] == INF_DIST || row[i] == INF_DIST) continue;
+            h = std::max(h, d[i] > row[i] ? d[i] - row[i] : row[i] - d[i]);
+        }
+        return h;
+    }
+    const std::vector<int>& landmarks() const { return chosen; }
+
+private:
+    size_t k;
+    std::vector<long long> dist;  // dist[v * k + i] = d(landmark i, v)
+    std::vector<int> chosen;
+    const long long* row;
+};
+
+// Ե·: s -> t queries that only touch the neighborhood the search
+// explores. The object keeps its distance arrays between queries and
+// resets just the entries the last query touched. bidirectional() runs the
+// backward search over reverse, which defaults to the graph itself (fine
+// for undirected graphs); pass the transposed graph for directed ones.
+template <typename G>
+class PointToPoint {
+public:
+    explicit PointToPoint(const G& graph) : PointToPoint(graph, graph) {}
+    PointToPoint(const G& graph, const G& reverse)
+        : forward(graph, size_t(graph.getVertices())), backward(reverse, size_t(graph.getVertices())) {}
+
+    // Returns INF_DIST if t is unreachable; fills path (s first) if given
+    long long bidirectional(int s, int t, std::vector<int>* path = nullptr);
+    template <typename H>
+    long long astar(int s, int t, H& heuristic, std::vector<int>* path = nullptr);
+
+    // vertices reached by the last query
+    size_t touched() const { return forward.touched.size() + backward.touched.size(); }
+
+private:
+    struct Side {
+        Side(const G& graph, size_t n) : graph(graph), dist(n, INF_DIST), pred(n, -1), heap(n) {}
+        void reset() {
+            for (int v : touched) {
+                dist[v] = INF_DIST;
+                pred[v] = -1;
+            }
+            touched.clear();
+            heap.clear();
+        }
+        void reach(int v, long long d, int p) {
+            if (dist[v] == INF_DIST) touched.push_back(v);
+            dist[v] = d;
+            pred[v] = p;
+        }
+        const G& graph;
+        std::vector<long long> dist;
+        std::vector<int> pred;
+        IndexedHeap<long long> heap;
+        std::vector<int> touched;
+    };
+
+    Side forward, backward;
+};
+
+template <typename G>
+long long PointToPoint<G>::bidirectional(int s, int t, std::vector<int>* path) {
+    forward.reset();
+    backward.reset();
+    forward.reach(s, 0, -1);
+    forward.heap.push(s, 0);
+    backward.reach(t, 0, -1);
+    backward.heap.push(t, 0);
+    long long best = s == t ? 0 : INF_DIST;
+    int meetU = s, meetV = s;  // best path is s ~> meetU -> meetV ~> t
+
+    // stop once no unexplored path can beat best: topF + topB >= best
+    while (!forward.heap.empty() && !backward.heap.empty()
+        && forward.heap.topKey() + backward.heap.topKey() < best) {
+        bool fwd = forward.heap.size() <= backward.heap.size();
+        Side& a = fwd ? forward : backward;
+        Side& b = fwd ? backward : forward;
+        int u = a.heap.pop();
+        long long du = a.dist[u];
+        for (auto edge : a.graph.neighbors(u)) {
+            int v = edge.first;
+            long long nd = du + edge.second;
+            if (nd < a.dist[v]) {
+                a.reach(v, nd, u);
+                a.heap.push(v, nd);
+            }
+            if (b.dist[v] != INF_DIST && nd + b.dist[v] < best) {
+                best = nd + b.dist[v];
+                meetU = fwd ? u : v;
+                meetV = fwd ? v : u;
+            }
+        }
+    }
+
+    if (path) {
+        path->clear();
+        if (best != INF_DIST) {
+            for (int v = meetU; v >= 0; v = forward.pred[v]) path->push_back(v);
+            std::reverse(path->begin(), path->end());
+            if (meetV != meetU)
+                for (int v = meetV; v >= 0; v = backward.pred[v]) path->push_back(v);
+        }
+    }
+    return best;
+}
+
+template <typename G>
+template <typename H>
+long long PointToPoint<G>::astar(int s, int t, H& heuristic, std::vector<int>* path) {
+    forward.reset();
+    backward.reset();
+    heuristic.target(t);
+    forward.reach(s, 0, -1);
+    forward.heap.push(s, heuristic(s));
+    while (!forward.heap.empty()) {
+        int u = forward.heap.pop();
+        if (u == t) break;
+        long long du = forward.dist[u];
+        for (auto edge : forward.graph.neighbors(u)) {
+            int v = edge.first;
+            long long nd = du + edge.second;
+            if (nd < forward.dist[v]) {
+                // an admissible but inconsistent heuristic may reopen v; push() re-queues it
+                forward.reach(v, nd, u);
+                forward.heap.push(v, nd + heuristic(v));
+            }
+        }
+    }
+
+    if (path) {
+        path->clear();
+        if (forward.dist[t] != INF_DIST) {
+            for (int v = t; v >= 0; v = forward.pred[v]) path->push_back(v);
+            std::reverse(path->begin(), path->end());
+        }
+    }
+    return forward.dist[t];
+}
+
+// Reusable barrier for a fixed team of threads
+class Barrier {
+public:
+    explicit Barrier(unsigned count) : count(count), waiting(0), generation(0) {}
+    void wait() {
+        std::unique_lock<std::mutex> lock(m);
+        unsigned gen = generation;
+        if (++waiting == count) {
+            waiting = 0;
+            ++generation;
+            cv.notify_all();
+        }
+        else cv.wait(lock, [&] { return gen != generation; });
+    }
+
+private:
+    std::mutex m;
+    std::condition_variable cv;
+    unsigned count, waiting, generation;
+};
+
+// Lowers a to value if that is smaller; true if this call changed it
+inline bool atomicMin(std::atomic<long long>& a, long long value) {
+    long long old = a.load(std::memory_order_relaxed);
+    while (value < old) {
+        if (a.compare_exchange_weak(old, value, std::memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+// Delta-stepping (Meyer & Sanders). Vertices are kept in buckets of width
+// delta. The lowest bucket is settled in light phases, which relax edges
+// of weight <= delta until the bucket stops refilling, followed by one
+// heavy phase over the vertices it removed. Each thread keeps its own
+// circular bucket array and pushes every vertex it improves there; at each
+// phase the threads' current buckets are concatenated and split evenly.
+// Distances are lowered with atomic compare-exchange, and stale bucket
+// entries are skipped. pred is built afterwards as a tree of tight edges
+// grown outward from the source, so every chain ends at the source even
+// across zero-weight edges. delta = 0 picks maxWeight / average degree. Requires weights >= 0.
+template <typename CSR>
+ShortestPaths deltaStepping(const CSR& graph, int source, long long delta = 0, unsigned threads = 0) {
+    threads = resolveThreads(threads);
+    const size_t n = size_t(graph.getVertices());
+    auto off = graph.offsetData();
+    const int* adj = graph.adjData();
+    const int* wt = graph.weightData();
+    long long maxWeight = std::max(graph.getMaxWeight(), 0);
+    if (delta <= 0) {
+        long long degree = n ? (long long)(graph.getArcs() / n) : 1;
+        delta = std::max(1LL, maxWeight / std::max(1LL, degree));
+    }
+    // pending distances always lie within maxWeight + delta of the current bucket
+    const size_t slots = size_t(maxWeight / delta) + 2;
+
+    std::unique_ptr<std::atomic<long long>[]> dist(new std::atomic<long long>[n]);
+    for (size_t v = 0; v < n; ++v) dist[v].store(INF_DIST, std::memory_order_relaxed);
+    dist[source].store(0, std::memory_order_relaxed);
+
+    struct Local {
+        std::vector<std::vector<int>> bucket;
+        std::vector<int> front;    // this thread's share of the current bucket
+        std::vector<int> removed;  // vertices settled in the current bucket, for the heavy phase
+        long long next;            // lowest bucket id holding entries
+    };
+    std::vector<Local> local(threads);
+    for (Local& l : local) l.bucket.resize(slots);
+    local[0].bucket[0].push_back(source);
+    Barrier barrier(threads);
+
+    parallelFor(threads, threads, [&](size_t, size_t, unsigned t) {
+        Local& me = local[t];
+        auto relax = [&](int v, long long nd) {
+            if (atomicMin(dist[v], nd)) me.bucket[size_t(nd / delta) % slots].push_back(v);
+        };
+        auto scan = [&](bool light, long long k) {
+            size_t total = 0;
+            for (Local& l : local) total += l.front.size();
+            size_t lo = total * t / threads, hi = total * (t + 1) / threads, base = 0;
+            for (Local& l : local) {
+                size_t a = std::max(lo, base), b = std::min(hi, base + l.front.size());
+                for (size_t i = a; i < b; ++i) {
+                    int u = l.front[i - base];
+                    long long du = dist[u].load(std::memory_order_relaxed);
+                    if (light && du / delta != k) continue;  // stale entry
+                    if (light) me.removed.push_back(u);
+                    for (size_t p = off[u]; p < off[u + 1]; ++p) {
+                        if ((wt[p] <= delta) == light) relax(adj[p], du + wt[p]);
+                    }
+                }
+                base += l.front.size();
+            }
+            return total;
+        };
+
+        for (long long k = 0; ; ) {
+            // light phases until bucket k stays empty everywhere
+            for (;;) {
+                me.front.clear();
+                me.front.swap(me.bucket[size_t(k) % slots]);
+                barrier.wait();
+                size_t total = scan(true, k);
+                barrier.wait();
+                if (total == 0) break;
+            }
+            // heavy phase: the removed sets stand in as fronts
+            me.front.swap(me.removed);
+            me.removed.clear();
+            barrier.wait();
+            scan(false, k);
+            barrier.wait();
+
+            me.next = -1;
+            for (size_t i = 1; i < slots; ++i) {
+                if (!me.bucket[size_t(k + i) % slots].empty()) {
+                    me.next = k + (long long)i;
+                    break;
+                }
+            }
+            barrier.wait();
+            long long next = -1;
+            for (Local& l : local)
+                if (l.next >= 0 && (next < 0 || l.next < next)) next = l.next;
+            barrier.wait();
+            if (next < 0) break;
+            k = next;
+        }
+    });
+
+    // pred: level-synchronous search over tight edges (dist[u] + w ==
+    // dist[v]) from the source. A vertex is claimed once, by CAS, from a
+    // vertex already in the tree, so the result is a tree rooted at source.
+    ShortestPaths r;
+    r.dist.resize(n);
+    r.pred.resize(n);
+    std::unique_ptr<std::atomic<int>[]> pred(new std::atomic<int>[n]);
+    for (size_t v = 0; v < n; ++v) {
+        r.dist[v] = dist[v].load(std::memory_order_relaxed);
+        pred[v].store(-1, std::memory_order_relaxed);
+    }
+    pred[source].store(source, std::memory_order_relaxed);
+    std::vector<int> frontier(1, source);
+    std::vector<std::vector<int>> found(threads);
+    while (!frontier.empty()) {
+        for (auto& f : found) f.clear();
+        parallelFor(frontier.size(), frontier.size() < 1024 ? 1 : threads, [&](size_t b, size_t e, unsigned t) {
+            for (size_t i = b; i < e; ++i) {
+                int u = frontier[i];
+                for (size_t p = off[u]; p < off[u + 1]; ++p) {
+                    int v = adj[p], none = -1;
+                    if (r.dist[u] + wt[p] != r.dist[v]) continue;
+                    if (pred[v].load(std::memory_order_relaxed) >= 0) continue;
+                    if (pred[v].compare_exchange_strong(none, u, std::memory_order_relaxed)) found[t].push_back(v);
+                }
+            }
+        });
+        frontier.clear();
+        for (auto& f : found) frontier.insert(frontier.end(), f.begin(), f.end());
+    }
+    for (size_t v = 0; v < n; ++v) r.pred[v] = pred[v].load(std::memory_order_relaxed);
+    r.pred[source] = -1;
+    return r;
+}
+
+// Դ·: row i of the result (sources.size() x V, row-major) holds the
+// distances from sources[i]. Worker threads share the read-only graph and
+// take the next source from an atomic counter, each reusing one queue and
+// writing straight into its row, so nothing is reset between sources.
+template <typename G>
+std::vector<long long> multiSourceDistances(const G& graph, const std::vector<int>& sources,
+    unsigned threads = 0, QueueKind kind = QueueKind::Auto) {
+    size_t n = size_t(graph.getVertices());
+    std::vector<long long> dist(sources.size() * n, INF_DIST);
+    int maxWeight = std::max(graph.getMaxWeight(), 0);
+    if (kind == QueueKind::Auto)
+        kind = graph.getMinWeight() >= 0 && maxWeight <= DIAL_MAX_WEIGHT ? QueueKind::Buckets : QueueKind::Heap;
+    threads = std::min<unsigned>(resolveThreads(threads), unsigned(std::max<size_t>(sources.size(), 1)));
+    std::atomic<size_t> next(0);
+    parallelFor(threads, threads, [&](size_t, size_t, unsigned) {
+        BucketQueue buckets(kind == QueueKind::Buckets ? n : 0, maxWeight);
+        IndexedHeap<long long> heap(kind == QueueKind::Heap ? n : 0);
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < sources.size(); ) {
+            long long* row = dist.data() + i * n;
+            if (kind == QueueKind::Buckets) dijkstraWith(graph, sources[i], -1, buckets, row, nullptr);
+            else dijkstraWith(graph, sources[i], -1, heap, row, nullptr);
+        }
+    });
+    return dist;
+}
+
+// Floyd-Warshall works on int so eight distances fit one AVX2 register;
+// INF + INF still fits in an int
+const int FW_INF = INT_MAX / 2;
+
+// c[i][j] = min(c[i][j], a[i][k] + b[k][j]) over one block x block tile,
+// k outermost so that it is also plain Floyd-Warshall when c aliases a or b.
+// The j loop has no branches, so the compiler vectorizes it (GCC at -O3).
+inline void minPlusTile(int* c, const int* a, const int* b, size_t stride, size_t block) {
+    for (size_t k = 0; k < block; ++k) {
+        const int* bk = b + k * stride;
+        for (size_t i = 0; i < block; ++i) {
+            int aik = a[i * stride + k];
+            int* ci = c + i * stride;
+            for (size_t j = 0; j < block; ++j) ci[j] = std::min(ci[j], aik + bk[j]);
+        }
+    }
+}
+
+// ֿ Floyd-Warshall (Venkataraman et al.) over a padded n x n matrix.
+// For each diagonal tile kb: close the tile itself, then its row and
+// column of tiles against it, then every other tile (i, j) against
+// (i, kb) and (kb, j). Phases 2 and 3 run in parallel. Distances must stay
+// below FW_INF; entries equal to FW_INF mean unreachable.
+std::vector<int> floydWarshall(std::vector<int> d, size_t n, unsigned threads = 0, size_t block = 64) {
+    size_t tiles = (n + block - 1) / block, stride = tiles * block;
+    std::vector<int> m(stride * stride, FW_INF);
+    for (size_t i = 0; i < stride; ++i) m[i * stride + i] = 0;
+    for (size_t i = 0; i < n; ++i)
+        std::copy(d.begin() + i * n, d.begin() + (i + 1) * n, m.begin() + i * stride);
+    auto tile = [&](size_t ti, size_t tj) { return m.data() + ti * block * stride + tj * block; };
+
+    for (size_t kb = 0; kb < tiles; ++kb) {
+        int* diag = tile(kb, kb);
+        minPlusTile(diag, diag, diag, stride, block);
+        parallelFor(tiles, threads, [&](size_t b, size_t e, unsigned) {
+            for (size_t t = b; t < e; ++t) {
+                if (t == kb) continue;
+                minPlusTile(tile(kb, t), diag, tile(kb, t), stride, block);
+                minPlusTile(tile(t, kb), tile(t, kb), diag, stride, block);
+            }
+        });
+        parallelFor(tiles * tiles, threads, [&](size_t b, size_t e, unsigned) {
+            for (size_t t = b; t < e; ++t) {
+                size_t ti = t / tiles, tj = t % tiles;
+                if (ti == kb || tj == kb) continue;
+                minPlusTile(tile(ti, tj), tile(ti, kb), tile(kb, tj), stride, block);
+            }
+        });
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        std::copy(m.begin() + i * stride, m.begin() + i * stride + n, d.begin() + i * n);
+    return d;
+}
+
+// All-pairs distances (V x V, row-major). Dense graphs whose paths fit in
+// an int go through blocked Floyd-Warshall, the rest through one Dijkstra
+// per source.
+template <typename G>
+std::vector<long long> allPairsDistances(const G& graph, unsigned threads = 0) {
+    size_t n = size_t(graph.getVertices());
+    size_t arcs = 0;
+    for (size_t u = 0; u < n; ++u) arcs += graph.neighbors(int(u)).size();
+    long long longest = (long long)std::max(graph.getMaxWeight(), 0) * (long long)std::max<size_t>(n, 1);
+    if (graph.getMinWeight() < 0 || arcs * 8 < n * n || longest >= FW_INF) {
+        std::vector<int> sources(n);
+        for (size_t v = 0; v < n; ++v) sources[v] = int(v);
+        return multiSourceDistances(graph, sources, threads);
+    }
+
+    std::vector<int> d(n * n, FW_INF);
+    for (size_t u = 0; u < n; ++u) {
+        d[u * n + u] = 0;
+        for (auto edge : graph.neighbors(int(u))) {
+            int& x = d[u * n + size_t(edge.first)];
+            x = std::min(x, edge.second);
+        }
+    }
+    d = floydWarshall(std::move(d), n, threads);
+    std::vector<long long> out(n * n);
+    for (size_t i = 0; i < n * n; ++i) out[i] = d[i] >= FW_INF ? INF_DIST : d[i];
+    return out;
+}
+
 // Kruskal С㷨
+// Union by size with path halving: find() is a loop that points every
+// other node on the path at its grandparent, so no recursion is needed
+// and trees stay O(log n) deep.
 class UnionFind {
 public:
-    UnionFind(int n) : parent(n), rank(n, 0) {
+    UnionFind(int n) : parent(n), size(n, 1) {
         for (int i = 0; i < n; ++i) parent[i] = i;
     }
 
     int find(int x) {
-        if (parent[x] != x) parent[x] = find(parent[x]);
-        return parent[x];
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
     }
 
     bool unionSets(int x, int y) {
@@ -169,25 +1636,83 @@ public:
         int rootY = find(y);
         if (rootX == rootY) return false;
 
-        if (rank[rootX] > rank[rootY]) {
-            parent[rootY] = rootX;
+        if (size[rootX] < size[rootY]) std::swap(rootX, rootY);
+        parent[rootY] = rootX;
+        size[rootX] += size[rootY];
+        return true;
+    }
+
+    int setSize(int x) { return size[find(x)]; }
+
+private:
+    std::vector<int> parent;
+    std::vector<int> size;
+};
+
+// 鼯: lock-free union-find (Anderson & Woll, Jayanti & Tarjan).
+// parent[] is the only shared state. A root is linked with one CAS on its
+// own parent slot, always beneath the root of higher priority, where
+// priority is a fixed bijective hash of the index; this acts as a random
+// linking order without storing ranks, and cannot form a cycle. find()
+// halves paths with a CAS that may fail harmlessly when another thread
+// got there first. All operations may run concurrently.
+class ConcurrentUnionFind {
+public:
+    explicit ConcurrentUnionFind(int n) : n(n), parent(new std::atomic<int>[size_t(n)]), sets(n) {
+        for (int i = 0; i < n; ++i) parent[i].store(i, std::memory_order_relaxed);
+    }
+
+    int find(int x) {
+        for (;;) {
+            int p = parent[x].load(std::memory_order_acquire);
+            if (p == x) return x;
+            int gp = parent[p].load(std::memory_order_acquire);
+            if (p != gp) parent[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+            x = gp;
         }
-        else if (rank[rootX] < rank[rootY]) {
-            parent[rootX] = rootY;
+    }
+
+    // true if this call joined two different sets
+    bool unite(int x, int y) {
+        for (;;) {
+            x = find(x);
+            y = find(y);
+            if (x == y) return false;
+            if (priority(x) > priority(y)) std::swap(x, y);
+            int expected = x;
+            if (parent[x].compare_exchange_strong(expected, y, std::memory_order_acq_rel)) {
+                sets.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
         }
-        else {
-            parent[rootY] = rootX;
-            ++rank[rootX];
+    }
+
+    bool sameSet(int x, int y) {
+        for (;;) {
+            x = find(x);
+            y = find(y);
+            if (x == y) return true;
+            // x still a root means the two were apart at some instant
+            if (parent[x].load(std::memory_order_acquire) == x) return false;
         }
-        return true;
     }
 
+    int getVertices() const { return n; }
+    int countSets() const { return sets.load(std::memory_order_relaxed); }
+
 private:
-    std::vector<int> parent;
-    std::vector<int> rank;
+    static uint32_t priority(int x) {
+        uint32_t h = uint32_t(x) * 0x9E3779B1u;  // odd multiplier: a bijection
+        return h ^ (h >> 16);
+    }
+
+    int n;
+    std::unique_ptr<std::atomic<int>[]> parent;
+    std::atomic<int> sets;
 };
 
-void kruskalWithPriorityQueue(const Graph& graph) {
+template <typename G>
+void kruskalWithPriorityQueue(const G& graph) {
     int vertices = graph.getVertices();
     using Edge = std::tuple<int, int, int>; // {weight, u, v}
 
@@ -195,7 +1720,7 @@ void kruskalWithPriorityQueue(const Graph& graph) {
 
     // б߼ȼ
     for (int u = 0; u < vertices; ++u) {
-        for (auto& edge : graph.getAdjList()[u]) {
+        for (auto edge : graph.neighbors(u)) {
             int v = edge.first, weight = edge.second;
             if (u < v) { // ظ
                 edgeQueue.push({ weight, u, v });
@@ -228,6 +1753,241 @@ void kruskalWithPriorityQueue(const Graph& graph) {
     }
 }
 
+// Each undirected edge once (u < v), self-loops dropped
+template <typename G>
+std::vector<WeightedEdge> extractEdges(const G& graph) {
+    std::vector<WeightedEdge> edges;
+    for (int u = 0; u < graph.getVertices(); ++u) {
+        for (auto edge : graph.neighbors(u)) {
+            if (u < edge.first) edges.push_back({ u, edge.first, edge.second });
+        }
+    }
+    return edges;
+}
+
+// Stable LSD radix sort on weight, 8 bits per pass; passes in which every
+// key has the same digit are skipped. The sign bit is flipped so negative
+// weights order correctly as unsigned keys.
+void radixSortByWeight(std::vector<WeightedEdge>& edges) {
+    std::vector<WeightedEdge> tmp(edges.size());
+    auto key = [](const WeightedEdge& e) { return uint32_t(e.weight) ^ 0x80000000u; };
+    for (int shift = 0; shift < 32; shift += 8) {
+        size_t count[257] = { 0 };
+        for (auto& e : edges) ++count[((key(e) >> shift) & 0xff) + 1];
+        if (std::find(count + 1, count + 257, edges.size()) != count + 257) continue;
+        for (int d = 0; d < 256; ++d) count[d + 1] += count[d];
+        for (auto& e : edges) tmp[count[(key(e) >> shift) & 0xff]++] = e;
+        edges.swap(tmp);
+    }
+}
+
+// Kruskal over a flat, radix-sorted edge array; returns the minimum
+// spanning forest
+template <typename G>
+std::vector<WeightedEdge> kruskalMST(const G& graph) {
+    std::vector<WeightedEdge> edges = extractEdges(graph), mst;
+    radixSortByWeight(edges);
+    UnionFind uf(graph.getVertices());
+    for (auto& e : edges) {
+        if (mst.size() + 1 >= size_t(graph.getVertices())) break;
+        if (uf.unionSets(e.u, e.v)) mst.push_back(e);
+    }
+    return mst;
+}
+
+const size_t FILTER_KRUSKAL_CUTOFF = 1 << 12;
+
+// Filter-Kruskal (Osipov, Sanders, Singler): partition the edges around a
+// sampled pivot weight, solve the light half first, then drop heavy edges
+// whose endpoints are already connected before touching them further.
+// On graphs much denser than a tree most heavy edges are filtered out
+// without ever being sorted. The partition is three-way (<, ==, > pivot),
+// so a pivot equal to the largest or smallest weight still splits the
+// range, and a range of equal weights needs no sort at all. Ranges are
+// kept on an explicit stack, lightest on top.
+template <typename G>
+std::vector<WeightedEdge> filterKruskalMST(const G& graph) {
+    std::vector<WeightedEdge> edges = extractEdges(graph), mst, part;
+    UnionFind uf(graph.getVertices());
+    std::vector<std::pair<size_t, size_t>> ranges(1, { 0, edges.size() });
+    while (!ranges.empty() && mst.size() + 1 < size_t(graph.getVertices())) {
+        size_t lo = ranges.back().first, hi = ranges.back().second;
+        ranges.pop_back();
+        // filter: keep edges that still join two components
+        size_t keep = lo;
+        for (size_t i = lo; i < hi; ++i)
+            if (uf.find(edges[i].u) != uf.find(edges[i].v)) edges[keep++] = edges[i];
+        hi = keep;
+
+        if (hi - lo > FILTER_KRUSKAL_CUTOFF) {
+            std::vector<int> sample;
+            for (size_t i = 0; i < 31; ++i) sample.push_back(edges[lo + (hi - lo) * i / 31].weight);
+            std::nth_element(sample.begin(), sample.begin() + 15, sample.end());
+            int pivot = sample[15];
+            size_t less = size_t(std::partition(edges.begin() + lo, edges.begin() + hi,
+                [pivot](const WeightedEdge& e) { return e.weight < pivot; }) - edges.begin());
+            size_t equal = size_t(std::partition(edges.begin() + less, edges.begin() + hi,
+                [pivot](const WeightedEdge& e) { return e.weight == pivot; }) - edges.begin());
+            if (less > lo || equal < hi) {
+                if (equal < hi) ranges.push_back({ equal, hi });
+                ranges.push_back({ less, equal });
+                if (less > lo) ranges.push_back({ lo, less });
+                continue;
+            }
+            // every weight equals the pivot: any order is a Kruskal order
+            for (size_t i = lo; i < hi; ++i) {
+                if (mst.size() + 1 >= size_t(graph.getVertices())) break;
+                if (uf.unionSets(edges[i].u, edges[i].v)) mst.push_back(edges[i]);
+            }
+            continue;
+        }
+        // small: plain Kruskal on the range
+        part.assign(edges.begin() + lo, edges.begin() + hi);
+        radixSortByWeight(part);
+        for (auto& e : part) {
+            if (mst.size() + 1 >= size_t(graph.getVertices())) break;
+            if (uf.unionSets(e.u, e.v)) mst.push_back(e);
+        }
+    }
+    return mst;
+}
+
+// ͨ: every thread unites the edges of its share of vertices
+// into one ConcurrentUnionFind. Labels are numbered like
+// connectedComponents, in order of each component's smallest vertex.
+inline std::vector<int> labelSets(ConcurrentUnionFind& uf, unsigned threads, int* count) {
+    size_t n = size_t(uf.getVertices());
+    std::vector<int> root(n), label(n, -1), id(n, -1);
+    parallelFor(n, threads, [&](size_t b, size_t e, unsigned) {
+        for (size_t v = b; v < e; ++v) root[v] = uf.find(int(v));
+    });
+    int components = 0;
+    for (size_t v = 0; v < n; ++v) {
+        if (id[root[v]] < 0) id[root[v]] = components++;
+        label[v] = id[root[v]];
+    }
+    if (count) *count = components;
+    return label;
+}
+
+template <typename G>
+std::vector<int> parallelComponents(const G& graph, unsigned threads = 0, int* count = nullptr) {
+    ConcurrentUnionFind uf(graph.getVertices());
+    parallelFor(size_t(graph.getVertices()), threads, [&](size_t b, size_t e, unsigned) {
+        for (size_t u = b; u < e; ++u)
+            for (auto edge : graph.neighbors(int(u)))
+                if (int(u) < edge.first) uf.unite(int(u), edge.first);
+    });
+    return labelSets(uf, threads, count);
+}
+
+// Connectivity over edges that arrive in batches, e.g. candidate pairs
+// from a deduplication pipeline. Each batch is united in parallel, and
+// queries may run while other threads add batches.
+class StreamingComponents {
+public:
+    StreamingComponents(int vertices, unsigned threads = 0) : uf(vertices), threads(threads) {}
+
+    void addBatch(const std::vector<std::pair<int, int>>& pairs) {
+        parallelFor(pairs.size(), threads, [&](size_t b, size_t e, unsigned) {
+            for (size_t i = b; i < e; ++i) uf.unite(pairs[i].first, pairs[i].second);
+        });
+    }
+    bool connected(int u, int v) { return uf.sameSet(u, v); }
+    int components() const { return uf.countSets(); }
+    std::vector<int> labels(int* count = nullptr) { return labelSets(uf, threads, count); }
+
+private:
+    ConcurrentUnionFind uf;
+    unsigned threads;
+};
+
+//  Boruvka: in each round every component picks its lightest outgoing
+// edge by an atomic min on (weight, edge index), which breaks ties the
+// same way everywhere so the picks form a forest. Each component hooks
+// onto the component across its edge; of two components that pick each
+// other, the smaller id stays the root. Pointer jumping then flattens the
+// hooks to roots, and edges inside a component are filtered out before
+// the next round. Every step is a parallel pass over edges or vertices.
+template <typename G>
+std::vector<WeightedEdge> boruvkaMST(const G& graph, unsigned threads = 0) {
+    threads = resolveThreads(threads);
+    const size_t n = size_t(graph.getVertices());
+    std::vector<WeightedEdge> edges = extractEdges(graph), mst;
+    std::vector<int> comp(n), hook(n), parent(n), next(n);
+    std::unique_ptr<std::atomic<uint64_t>[]> best(new std::atomic<uint64_t>[n]);
+    std::vector<std::vector<WeightedEdge>> picked(threads), kept(threads);
+    for (size_t v = 0; v < n; ++v) comp[v] = int(v);
+    const uint64_t NONE = ~uint64_t(0);
+
+    while (!edges.empty()) {
+        parallelFor(n, threads, [&](size_t b, size_t e, unsigned) {
+            for (size_t v = b; v < e; ++v) best[v].store(NONE, std::memory_order_relaxed);
+        });
+        parallelFor(edges.size(), threads, [&](size_t b, size_t e, unsigned) {
+            for (size_t i = b; i < e; ++i) {
+                uint64_t key = uint64_t(uint32_t(edges[i].weight) ^ 0x80000000u) << 32 | i;
+                for (int c : { comp[edges[i].u], comp[edges[i].v] }) {
+                    uint64_t old = best[c].load(std::memory_order_relaxed);
+                    while (key < old && !best[c].compare_exchange_weak(old, key, std::memory_order_relaxed)) {}
+                }
+            }
+        });
+        parallelFor(n, threads, [&](size_t b, size_t e, unsigned) {
+            for (size_t c = b; c < e; ++c) {
+                uint64_t key = best[c].load(std::memory_order_relaxed);
+                hook[c] = int(c);
+                if (comp[c] != int(c) || key == NONE) continue;
+                const WeightedEdge& x = edges[size_t(uint32_t(key))];
+                hook[c] = comp[x.u] == int(c) ? comp[x.v] : comp[x.u];
+            }
+        });
+        // parallelFor may run fewer threads than asked; stale slots must be empty
+        for (unsigned t = 0; t < threads; ++t) picked[t].clear();
+        parallelFor(n, threads, [&](size_t b, size_t e, unsigned t) {
+            for (size_t v = b; v < e; ++v) {
+                int h = hook[v];
+                if (comp[v] != int(v)) parent[v] = comp[v];
+                else if (h == int(v) || (hook[h] == int(v) && int(v) < h)) parent[v] = int(v);
+                else {
+                    parent[v] = h;
+                    picked[t].push_back(edges[size_t(uint32_t(best[v].load(std::memory_order_relaxed)))]);
+                }
+            }
+        });
+        size_t hooked = 0;
+        for (auto& p : picked) {
+            mst.insert(mst.end(), p.begin(), p.end());
+            hooked += p.size();
+        }
+        if (hooked == 0) break;
+
+        for (bool changed = true; changed; ) {
+            std::atomic<bool> any(false);
+            parallelFor(n, threads, [&](size_t b, size_t e, unsigned) {
+                bool local = false;
+                for (size_t v = b; v < e; ++v) {
+                    next[v] = parent[parent[v]];
+                    local |= next[v] != parent[v];
+                }
+                if (local) any.store(true, std::memory_order_relaxed);
+            });
+            parent.swap(next);
+            changed = any.load(std::memory_order_relaxed);
+        }
+        comp.swap(parent);
+
+        for (unsigned t = 0; t < threads; ++t) kept[t].clear();
+        parallelFor(edges.size(), threads, [&](size_t b, size_t e, unsigned t) {
+            for (size_t i = b; i < e; ++i)
+                if (comp[edges[i].u] != comp[edges[i].v]) kept[t].push_back(edges[i]);
+        });
+        edges.clear();
+        for (auto& k : kept) edges.insert(edges.end(), k.begin(), k.end());
+    }
+    return mst;
+}
+
 // 
 int main() {
     Graph g(6);
@@ -248,5 +2008,447 @@ int main() {
     dijkstra(g, 0);
     kruskalWithPriorityQueue(g);
 
+    CutStructure cuts = cutStructure(g);
+    std::cout << "Articulation points: ";
+    for (int v : cuts.articulationPoints) std::cout << v << " ";
+    std::cout << std::endl << "Bridges: ";
+    for (auto& b : cuts.bridges) std::cout << b.first << "-" << b.second << " ";
+    std::cout << std::endl;
+
+    // the same algorithms on the CSR layout
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    std::cout << "CSR:" << std::endl;
+    BFS(csr, 0);
+    DFS(csr, 0);
+    dijkstra(csr, 0);
+    kruskalWithPriorityQueue(csr);
+
+    // a path that would overflow the call stack of a recursive DFS
+    {
+        const int n = 1 << 20;
+        std::vector<WeightedEdge> edges;
+        for (int v = 0; v + 1 < n; ++v) edges.push_back({ v, v + 1, 1 });
+        edges.push_back({ n / 2, n / 2 + 2, 1 });
+        CSRGraph path = CSRGraph::fromEdges(n, edges);
+        int components;
+        connectedComponents(path, &components);
+        CutStructure pc = cutStructure(path);
+        std::vector<int> order;
+        bool dag = topologicalOrder(CSRGraph::fromEdges(n, edges, false), order);
+        std::cout << "path of " << n << " vertices: " << components << " component(s), "
+            << pc.articulationPoints.size() << " articulation points, " << pc.bridges.size()
+            << " bridges, topological order " << (dag && order.size() == size_t(n) ? "ok" : "FAILED")
+            << std::endl;
+    }
+
+    // point-to-point queries on a road-like grid
+    {
+        const int side = 400, n = side * side, queries = 50;
+        std::mt19937 rng(2);
+        std::vector<WeightedEdge> edges;
+        std::vector<std::pair<double, double>> coords(n);
+        for (int y = 0; y < side; ++y) {
+            for (int x = 0; x < side; ++x) {
+                int v = y * side + x;
+                coords[v] = { double(x), double(y) };
+                if (x + 1 < side) edges.push_back({ v, v + 1, 10 + int(rng() % 10) });
+                if (y + 1 < side) edges.push_back({ v, v + side, 10 + int(rng() % 10) });
+            }
+        }
+        CSRGraph grid = CSRGraph::fromEdges(n, edges);
+        CoordinateHeuristic euclid(coords, 10);
+        ALTHeuristic<CSRGraph> alt(grid, 8);
+        PointToPoint<CSRGraph> p2p(grid);
+
+        double tFull = 0, tBi = 0, tCoord = 0, tAlt = 0;
+        size_t touchedBi = 0, touchedCoord = 0, touchedAlt = 0;
+        bool same = true;
+        auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        for (int i = 0; i < queries; ++i) {
+            int s = int(rng() % n), t = int(rng() % n);
+            auto q0 = std::chrono::steady_clock::now();
+            long long full = shortestPaths(grid, s).dist[t];
+            auto q1 = std::chrono::steady_clock::now();
+            same &= p2p.bidirectional(s, t) == full;
+            touchedBi += p2p.touched();
+            auto q2 = std::chrono::steady_clock::now();
+            same &= p2p.astar(s, t, euclid) == full;
+            touchedCoord += p2p.touched();
+            auto q3 = std::chrono::steady_clock::now();
+            same &= p2p.astar(s, t, alt) == full;
+            touchedAlt += p2p.touched();
+            auto q4 = std::chrono::steady_clock::now();
+            tFull += ms(q1 - q0);
+            tBi += ms(q2 - q1);
+            tCoord += ms(q3 - q2);
+            tAlt += ms(q4 - q3);
+        }
+        std::cout << "s-t queries on a " << side << "x" << side << " grid (ms, vertices touched): full "
+            << tFull / queries << ", bidirectional " << tBi / queries << " / " << touchedBi / queries
+            << ", A* coordinates " << tCoord / queries << " / " << touchedCoord / queries
+            << ", A* ALT " << tAlt / queries << " / " << touchedAlt / queries
+            << (same ? "" : " MISMATCH") << std::endl;
+    }
+
+    // distance matrices: batched Dijkstra against Floyd-Warshall
+    {
+        auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        const int n = 512;
+        std::mt19937 rng(4);
+        std::vector<WeightedEdge> edges;
+        for (int u = 0; u < n; ++u)
+            for (int v = u + 1; v < n; ++v)
+                if (rng() % 4 == 0) edges.push_back({ u, v, 1 + int(rng() % 1000) });
+        CSRGraph dense = CSRGraph::fromEdges(n, edges);
+        std::vector<int> sources(n);
+        for (int v = 0; v < n; ++v) sources[v] = v;
+
+        auto f0 = std::chrono::steady_clock::now();
+        std::vector<long long> looped;
+        for (int s : sources) {
+            ShortestPaths sp = shortestPaths(dense, s, -1, QueueKind::Heap);
+            looped.insert(looped.end(), sp.dist.begin(), sp.dist.end());
+        }
+        auto f1 = std::chrono::steady_clock::now();
+        std::vector<long long> batched = multiSourceDistances(dense, sources, 0, QueueKind::Heap);
+        auto f2 = std::chrono::steady_clock::now();
+        std::vector<int> naive(size_t(n) * n, FW_INF);
+        for (int v = 0; v < n; ++v) naive[size_t(v) * n + v] = 0;
+        for (auto& e : edges) {
+            naive[size_t(e.u) * n + e.v] = std::min(naive[size_t(e.u) * n + e.v], e.weight);
+            naive[size_t(e.v) * n + e.u] = std::min(naive[size_t(e.v) * n + e.u], e.weight);
+        }
+        std::vector<int> input = naive;
+        for (int k = 0; k < n; ++k)
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < n; ++j)
+                    if (naive[size_t(i) * n + k] + naive[size_t(k) * n + j] < naive[size_t(i) * n + j])
+                        naive[size_t(i) * n + j] = naive[size_t(i) * n + k] + naive[size_t(k) * n + j];
+        auto f3 = std::chrono::steady_clock::now();
+        std::vector<int> blocked = floydWarshall(input, n);
+        auto f4 = std::chrono::steady_clock::now();
+        std::vector<long long> all = allPairsDistances(dense);
+        bool same = batched == looped && blocked == naive && all == looped;
+        std::cout << "APSP on " << n << " vertices, " << edges.size() << " edges: dijkstra loop " << ms(f1 - f0)
+            << " ms, batched " << ms(f2 - f1) << " ms, Floyd-Warshall naive " << ms(f3 - f2)
+            << " ms, blocked " << ms(f4 - f3) << " ms" << (same ? "" : " MISMATCH") << std::endl;
+    }
+
+    // delta-stepping strong scaling
+    {
+        auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        struct Workload { const char* name; int vertices; std::vector<WeightedEdge> edges; };
+        Workload loads[] = {
+            { "RMAT-18", 1 << 18, rmatEdges(18, 16, 100) },
+            { "grid-512", 512 * 512, gridEdges(512, 100) },
+        };
+        for (Workload& w : loads) {
+            CSRGraph graph = CSRGraph::fromEdges(w.vertices, w.edges);
+            auto d0 = std::chrono::steady_clock::now();
+            ShortestPaths ref = shortestPaths(graph, 0, -1, QueueKind::Heap);
+            auto d1 = std::chrono::steady_clock::now();
+            std::cout << w.name << " (" << graph.getArcs() << " arcs): dijkstra " << ms(d1 - d0) << " ms, delta-stepping";
+            for (unsigned threads : { 1u, 2u, 4u, 8u }) {
+                auto d2 = std::chrono::steady_clock::now();
+                ShortestPaths ds = deltaStepping(graph, 0, 0, threads);
+                auto d3 = std::chrono::steady_clock::now();
+                std::cout << " " << threads << "T " << ms(d3 - d2) << " ms" << (ds.dist == ref.dist ? "" : " MISMATCH");
+            }
+            std::cout << std::endl;
+        }
+
+        // zero-weight edges: every pred chain must still end at the source
+        std::mt19937 rng(8);
+        bool ok = true;
+        for (int round = 0; round < 100 && ok; ++round) {
+            int n = 1 + int(rng() % 60);
+            std::vector<WeightedEdge> edges(rng() % 200);
+            for (auto& e : edges) e = { int(rng() % n), int(rng() % n), int(rng() % 3) };
+            CSRGraph graph = CSRGraph::fromEdges(n, edges, round % 2 == 0);
+            for (unsigned threads : { 1u, 4u }) {
+                ShortestPaths ds = deltaStepping(graph, 0, 1, threads);
+                ok &= ds.dist == shortestPaths(graph, 0).dist;
+                for (int v = 0; ok && v < n; ++v) {
+                    int steps = 0, x = v;
+                    for (; ds.dist[v] != INF_DIST && x != 0 && steps <= n; x = ds.pred[x], ++steps) {}
+                    ok = ds.dist[v] == INF_DIST || x == 0;
+                }
+            }
+        }
+        std::cout << "delta-stepping pred trees with zero-weight edges" << (ok ? " ok" : " MISMATCH") << std::endl;
+    }
+
+    // minimum spanning forests
+    {
+        auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        CSRGraph graph = CSRGraph::fromEdges(1 << 18, rmatEdges(18, 16, 1 << 20, 3));
+        auto total = [](const std::vector<WeightedEdge>& mst) {
+            long long s = 0;
+            for (auto& e : mst) s += e.weight;
+            return s;
+        };
+        auto k0 = std::chrono::steady_clock::now();
+        std::vector<WeightedEdge> edges = extractEdges(graph);
+        {
+            using Edge = std::tuple<int, int, int>;
+            std::priority_queue<Edge, std::vector<Edge>, std::greater<Edge>> pq;
+            for (auto& e : edges) pq.push({ e.weight, e.u, e.v });
+            UnionFind uf(graph.getVertices());
+            edges.clear();
+            for (; !pq.empty(); pq.pop())
+                if (uf.unionSets(std::get<1>(pq.top()), std::get<2>(pq.top())))
+                    edges.push_back({ std::get<1>(pq.top()), std::get<2>(pq.top()), std::get<0>(pq.top()) });
+        }
+        auto k1 = std::chrono::steady_clock::now();
+        std::vector<WeightedEdge> radix = kruskalMST(graph);
+        auto k2 = std::chrono::steady_clock::now();
+        std::vector<WeightedEdge> filtered = filterKruskalMST(graph);
+        auto k3 = std::chrono::steady_clock::now();
+        long long expect = total(edges);
+        std::cout << "MST of RMAT-18 (" << edges.size() << " edges, weight " << expect << "): priority_queue "
+            << ms(k1 - k0) << " ms, radix Kruskal " << ms(k2 - k1) << " ms, filter-Kruskal " << ms(k3 - k2) << " ms"
+            << (total(radix) == expect && total(filtered) == expect ? "" : " MISMATCH");
+        for (unsigned threads : { 1u, 2u, 4u }) {
+            auto k4 = std::chrono::steady_clock::now();
+            std::vector<WeightedEdge> boruvka = boruvkaMST(graph, threads);
+            auto k5 = std::chrono::steady_clock::now();
+            std::cout << ", Boruvka " << threads << "T " << ms(k5 - k4) << " ms"
+                << (total(boruvka) == expect && boruvka.size() == edges.size() ? "" : " MISMATCH");
+        }
+        std::cout << std::endl;
+
+        // small graphs, where later rounds have fewer edges than threads
+        std::mt19937 rng(7);
+        bool ok = true;
+        for (int round = 0; round < 200 && ok; ++round) {
+            int n = 2 + int(rng() % 40);
+            std::vector<WeightedEdge> few(rng() % 60);
+            for (auto& e : few) e = { int(rng() % n), int(rng() % n), 1 + int(rng() % 20) };
+            CSRGraph small = CSRGraph::fromEdges(n, few);
+            std::vector<WeightedEdge> ref = kruskalMST(small);
+            for (unsigned threads : { 2u, 6u, 16u }) {
+                std::vector<WeightedEdge> boruvka = boruvkaMST(small, threads);
+                ok &= boruvka.size() == ref.size() && total(boruvka) == total(ref);
+            }
+        }
+        std::cout << "Boruvka against Kruskal on small graphs with up to 16 threads" << (ok ? " ok" : " MISMATCH") << std::endl;
+
+        // skewed weights, where the sampled pivot is usually the largest weight
+        std::vector<WeightedEdge> skewed = rmatEdges(16, 16, 1000, 4);
+        for (auto& e : skewed)
+            if (rng() % 20 != 0) e.weight = 1000;
+        CSRGraph heavy = CSRGraph::fromEdges(1 << 16, skewed);
+        auto k6 = std::chrono::steady_clock::now();
+        std::vector<WeightedEdge> ref = kruskalMST(heavy);
+        auto k7 = std::chrono::steady_clock::now();
+        filtered = filterKruskalMST(heavy);
+        auto k8 = std::chrono::steady_clock::now();
+        std::cout << "MST with 95% of weights at the maximum: radix Kruskal " << ms(k7 - k6) << " ms, filter-Kruskal "
+            << ms(k8 - k7) << " ms" << (filtered.size() == ref.size() && total(filtered) == total(ref) ? "" : " MISMATCH") << std::endl;
+    }
+
+    // connected components: sequential against concurrent union-find
+    {
+        auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        const int n = 1 << 20;
+        std::vector<WeightedEdge> edges = rmatEdges(20, 1, 1, 5);
+        CSRGraph graph = CSRGraph::fromEdges(n, edges);
+        auto c0 = std::chrono::steady_clock::now();
+        int expect;
+        std::vector<int> ref = connectedComponents(graph, &expect);
+        auto c1 = std::chrono::steady_clock::now();
+        std::cout << "components of RMAT-20 (" << edges.size() << " edges): DFS " << ms(c1 - c0) << " ms";
+        for (unsigned threads : { 1u, 2u, 4u }) {
+            int count;
+            auto c2 = std::chrono::steady_clock::now();
+            std::vector<int> label = parallelComponents(graph, threads, &count);
+            auto c3 = std::chrono::steady_clock::now();
+            std::cout << ", union-find " << threads << "T " << ms(c3 - c2) << " ms"
+                << (label == ref && count == expect ? "" : " MISMATCH");
+        }
+        StreamingComponents stream(n);
+        std::vector<std::pair<int, int>> batch;
+        auto c4 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < edges.size(); ++i) {
+            batch.push_back({ edges[i].u, edges[i].v });
+            if (batch.size() == 1 << 16 || i + 1 == edges.size()) {
+                stream.addBatch(batch);
+                batch.clear();
+            }
+        }
+        auto c5 = std::chrono::steady_clock::now();
+        std::cout << ", streamed in 64k batches " << ms(c5 - c4) << " ms"
+            << (stream.components() == expect ? "" : " MISMATCH") << " (" << expect << " components)" << std::endl;
+    }
+
+    // loading: parallel text parsing against opening a mapped snapshot
+    {
+        auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        const char* textPath = "exp4_edges.txt";
+        const char* snapPath = "exp4_graph.csr";
+        std::vector<WeightedEdge> edges = rmatEdges(18, 16, 100, 6);
+        {
+            std::ofstream out(textPath, std::ios::binary);
+            out << "# RMAT-18 edge list: u v weight\n";
+            for (auto& e : edges) out << e.u << ' ' << e.v << ' ' << e.weight << '\n';
+        }
+        std::cout << "load " << edges.size() << " edges: text";
+        int vertices = 0;
+        std::vector<WeightedEdge> parsed;
+        bool same = true;
+        for (unsigned threads : { 1u, 4u }) {
+            auto l0 = std::chrono::steady_clock::now();
+            same &= loadEdgeList(textPath, vertices, parsed, threads);
+            auto l1 = std::chrono::steady_clock::now();
+            std::cout << " " << threads << "T " << ms(l1 - l0) << " ms";
+            same &= parsed.size() == edges.size()
+                && std::equal(parsed.begin(), parsed.end(), edges.begin(), [](const WeightedEdge& a, const WeightedEdge& b) {
+                    return a.u == b.u && a.v == b.v && a.weight == b.weight;
+                });
+        }
+        auto l2 = std::chrono::steady_clock::now();
+        CSRGraph graph = CSRGraph::fromEdges(vertices, parsed);
+        auto l3 = std::chrono::steady_clock::now();
+        same &= saveSnapshot(graph, snapPath);
+        auto l4 = std::chrono::steady_clock::now();
+        {
+            CSRSnapshot snapshot(snapPath);
+            auto l5 = std::chrono::steady_clock::now();
+            same &= snapshot.valid() && parallelBFS(snapshot, 0).dist == parallelBFS(graph, 0).dist
+                && deltaStepping(snapshot, 0).dist == shortestPaths(graph, 0).dist;
+            auto l6 = std::chrono::steady_clock::now();
+            same &= CSRSnapshot(snapPath, true).valid();
+            auto l7 = std::chrono::steady_clock::now();
+            std::cout << ", build CSR " << ms(l3 - l2) << " ms, open snapshot " << ms(l5 - l4)
+                << " ms, verified " << ms(l7 - l6) << " ms" << (same ? "" : " MISMATCH") << std::endl;
+        }
+
+        // a neighbor id out of range passes the header check but not verify,
+        // and an id of INT_MAX is rejected by the parser
+        {
+            std::fstream patch(snapPath, std::ios::binary | std::ios::in | std::ios::out);
+            int bad = vertices;
+            patch.seekp(std::streamoff(sizeof(SnapshotHeader) + (size_t(vertices) + 1) * sizeof(uint64_t)));
+            patch.write(reinterpret_cast<const char*>(&bad), sizeof bad);
+        }
+        const char maxIdText[] = "0 2147483647\n";
+        int maxIdVertices = 0;
+        std::vector<WeightedEdge> maxIdEdges;
+        bool rejected = CSRSnapshot(snapPath).valid() && !CSRSnapshot(snapPath, true).valid()
+            && !parseEdgeList(maxIdText, sizeof maxIdText - 1, maxIdVertices, maxIdEdges, 1);
+        std::cout << "corrupt snapshot and INT_MAX vertex id" << (rejected ? " rejected" : " ACCEPTED") << std::endl;
+        std::remove(textPath);
+        std::remove(snapPath);
+    }
+
+    // BFS with more threads than frontier vertices or bitmap words: a
+    // source with 8 neighbors that lead to hubs with many parallel edges
+    {
+        const int n = 200;
+        std::vector<WeightedEdge> edges;
+        for (int v = 1; v <= 8; ++v) edges.push_back({ 0, v, 1 });
+        for (int v = 1; v <= 8; ++v)
+            for (int k = 0; k < 600 + 200 * v; ++k) edges.push_back({ v, 8 + v, 1 });
+        for (int v = 17; v < n; ++v) edges.push_back({ 9 + v % 8, v, 1 });
+        CSRGraph hubs = CSRGraph::fromEdges(n, edges);
+        BFSResult one = parallelBFS(hubs, 0, 1);
+        bool ok = true;
+        for (unsigned threads : { 2u, 8u, 64u }) ok &= parallelBFS(hubs, 0, threads).dist == one.dist;
+        std::cout << "BFS on a small hub graph with up to 64 threads" << (ok ? " ok" : " MISMATCH") << std::endl;
+    }
+
+    // footprint and sweep cost of both layouts on a random graph
+    {
+        const int n = 1 << 18;
+        const size_t m = size_t(n) * 8;
+        std::mt19937 rng(1);
+        std::vector<WeightedEdge> edges(m);
+        for (auto& e : edges) e = { int(rng() % n), int(rng() % n), int(rng() % 100) + 1 };
+
+        Graph lg(n);
+        for (auto& e : edges) lg.addEdge(e.u, e.v, e.weight);
+        auto t0 = std::chrono::steady_clock::now();
+        CSRGraph cg = CSRGraph::fromEdges(n, edges);
+        auto t1 = std::chrono::steady_clock::now();
+
+        auto sweep = [](const auto& graph) {
+            long long s = 0;
+            for (int u = 0; u < graph.getVertices(); ++u)
+                for (auto edge : graph.neighbors(u)) s += edge.first ^ edge.second;
+            return s;
+        };
+        auto t2 = std::chrono::steady_clock::now();
+        long long a = sweep(lg);
+        auto t3 = std::chrono::steady_clock::now();
+        long long b = sweep(cg);
+        auto t4 = std::chrono::steady_clock::now();
+
+        // a std::list node holds the pair plus two links, before allocator overhead
+        size_t listBytes = 2 * m * (sizeof(std::pair<int, int>) + 2 * sizeof(void*))
+            + size_t(n) * sizeof(std::list<std::pair<int, int>>);
+        auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        std::cout << n << " vertices, " << m << " edges: list >= " << (listBytes >> 20)
+            << " MiB, CSR " << (cg.memoryBytes() >> 20) << " MiB (built in " << ms(t1 - t0)
+            << " ms); sweep list " << ms(t3 - t2) << " ms, CSR " << ms(t4 - t3) << " ms"
+            << (a == b ? "" : " MISMATCH") << std::endl;
+
+        // queue BFS on the list layout against the direction-optimizing one on CSR
+        auto t5 = std::chrono::steady_clock::now();
+        std::vector<int> level(n, -1);
+        std::queue<int> q;
+        level[0] = 0;
+        for (q.push(0); !q.empty(); q.pop()) {
+            for (auto& edge : lg.neighbors(q.front())) {
+                if (level[edge.first] < 0) {
+                    level[edge.first] = level[q.front()] + 1;
+                    q.push(edge.first);
+                }
+            }
+        }
+        auto t6 = std::chrono::steady_clock::now();
+        BFSResult bfs = parallelBFS(cg, 0);
+        auto t7 = std::chrono::steady_clock::now();
+        bool ok = bfs.dist == level;
+        for (int v = 1; ok && v < n; ++v)
+            ok = bfs.dist[v] < 0 || bfs.dist[bfs.parent[v]] == bfs.dist[v] - 1;
+        std::cout << "BFS: queue " << ms(t6 - t5) << " ms, direction-optimizing "
+            << ms(t7 - t6) << " ms" << (ok ? "" : " MISMATCH") << std::endl;
+
+        // lazy-deletion priority_queue (the old dijkstra) against the new queues
+        auto t8 = std::chrono::steady_clock::now();
+        std::vector<long long> lazy(n, INF_DIST);
+        size_t peak = 0;
+        {
+            using PLI = std::pair<long long, int>;
+            std::priority_queue<PLI, std::vector<PLI>, std::greater<PLI>> pq;
+            lazy[0] = 0;
+            for (pq.push({ 0, 0 }); !pq.empty(); ) {
+                peak = std::max(peak, pq.size());
+                PLI top = pq.top();
+                pq.pop();
+                if (top.first > lazy[top.second]) continue;
+                for (auto edge : cg.neighbors(top.second)) {
+                    if (top.first + edge.second < lazy[edge.first]) {
+                        lazy[edge.first] = top.first + edge.second;
+                        pq.push({ lazy[edge.first], edge.first });
+                    }
+                }
+            }
+        }
+        auto t9 = std::chrono::steady_clock::now();
+        ShortestPaths byHeap = shortestPaths(cg, 0, -1, QueueKind::Heap);
+        auto t10 = std::chrono::steady_clock::now();
+        ShortestPaths byBuckets = shortestPaths(cg, 0, -1, QueueKind::Buckets);
+        auto t11 = std::chrono::steady_clock::now();
+        ShortestPaths early = shortestPaths(cg, 0, n - 1);
+        auto t12 = std::chrono::steady_clock::now();
+        bool same = byHeap.dist == lazy && byBuckets.dist == lazy && early.dist[n - 1] == lazy[n - 1];
+        std::cout << "Dijkstra: lazy priority_queue " << ms(t9 - t8) << " ms (peak " << peak
+            << " entries), 4-ary heap " << ms(t10 - t9) << " ms, buckets " << ms(t11 - t10)
+            << " ms, 0 -> " << n - 1 << " only " << ms(t12 - t11) << " ms ("
+            << extractPath(early, n - 1).size() << " vertices on the path)"
+            << (same ? "" : " MISMATCH") << std::endl;
+    }
+
     return 0;
 }